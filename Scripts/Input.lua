@@ -0,0 +1,16 @@
+-- input.lua
+
+Input = 
+{
+    bindings =
+    {
+        W = "INPUT_MOVE_FORWARD",
+        S = "INPUT_MOVE_BACKWARD",
+        A = "INPUT_MOVE_LEFT",
+        D = "INPUT_MOVE_RIGHT",
+        E = "INPUT_MOVE_UP",
+        Q = "INPUT_MOVE_DOWN"
+    }
+}
+
+return Input;
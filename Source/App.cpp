@@ -5,13 +5,22 @@
 #include "Common.hpp"
 #include "Utilities/Macros.hpp"
 
+#include "Utilities/ActionMap.hpp"
 #include "Utilities/Container.hpp"
+#include "Utilities/HitchDetector.hpp"
+#include "Utilities/LatencyMonitor.hpp"
+#include "Utilities/Profiler.hpp"
+#include "Utilities/ResourceCache.hpp"
+#include "Utilities/StartupScheduler.hpp"
+#include "Utilities/Timer.hpp"
 
 #include "Utilities/WindowHandle.hpp"
 #include "Utilities/ContextHandle.hpp"
 #include "Utilities/WorldHandle.hpp"
 #include "Utilities/CameraHandle.hpp"
 
+#include "Services/RenderPipeline.hpp"
+
 #include "Managers/EventManager.hpp"
 #include "Managers/InputManager.hpp"
 #include "Managers/StateManager.hpp"
@@ -20,25 +29,62 @@
 #include "Entities/Entities.hpp"
 #include "States/DefaultState.hpp"
 
-App::App(void) : m_pEventManager(nullptr), m_pInputManager(nullptr) { }
+// < The frame time the application aims for, in microseconds. Whatever part
+// * of it the last frame did not use is handed to the EventManager's channels.
+#define TARGET_FRAME_MICROS		16667
+
+// < How often "-eventstats" appends a summary, in milliseconds.
+#define EVENT_STATS_INTERVAL	5000
+
+// < The most profiler samples kept for "-trace"; about a minute of frames.
+#define TRACE_SAMPLES			262144
+
+App::App(void) : m_pEventManager(nullptr), m_pInputManager(nullptr), m_pStateManager(nullptr), m_pActionMap(nullptr), m_pContainer(nullptr), m_pContext(nullptr), m_bShowProfile(false), m_nLastFrameMicros(0) { }
 
 App::~App(void) { }
 
 void App::Configure(Container* pContainer) {    
 
+	m_pContainer = pContainer;
+
+	// < Declare our services along with what each one resolves while being
+	// * created. The StartupScheduler creates them, independent ones in
+	// * parallel, once this returns.
+
 	/* EventManager */
-	m_pEventManager = pContainer->Register<EventManager, EventManager>( new EventManager());
+	// < Seeds its timers from the Leadwerks clock, which is main-thread only.
+	pContainer->Declare<EventManager>(SERVICE_MAIN_THREAD, [](Container&) {
+		return new EventManager();
+	});
 
 	/* StateManager */
-	m_pStateManager = pContainer->Register<StateManager, StateManager>(new StateManager(
-		pContainer,
-		pContainer->Resolve<EventManager>()));
+	// < Subscribes to the Bus, which is not thread-safe.
+	pContainer->Declare<StateManager, EventManager>(SERVICE_MAIN_THREAD, [](Container& container) {
+		return new StateManager(&container, container.Resolve<EventManager>());
+	});
 
 	/* Input Manager */
-	m_pInputManager = pContainer->Register<InputManager, InputManager>( new InputManager(
-		pContainer->Resolve<WindowHandle>()->getInst(), 
-		pContainer->Resolve<ContextHandle>()->getInst(),
-		pContainer->Resolve<EventManager>()));
+	pContainer->Declare<InputManager, WindowHandle, ContextHandle, EventManager>(SERVICE_MAIN_THREAD, [](Container& container) {
+		return new InputManager(
+			container.Resolve<WindowHandle>()->getInst(), 
+			container.Resolve<ContextHandle>()->getInst(),
+			container.Resolve<EventManager>());
+	});
+
+	/* Resource Cache */
+	// < Only created once a state asks for it.
+	pContainer->Declare<ResourceCache>(SERVICE_MAIN_THREAD | SERVICE_LAZY, [](Container&) {
+		return new ResourceCache();
+	});
+
+	/* Action Map */
+	// < Reads its script with its own Lua state, so it can load off the main thread.
+	pContainer->Declare<ActionMap>(SERVICE_ANY_THREAD, [](Container&) {
+		ActionMap* pActionMap = new ActionMap();
+		pActionMap->Load("./Scripts/Input.lua");
+
+		return pActionMap;
+	});
 
 	// < Register any states that are going to be used by our application.
 	// * In order for a state to be added through the StateManager,
@@ -49,8 +95,82 @@ void App::Configure(Container* pContainer) {
 
 bool App::Start(void) {
 
-	// < Add our default state and immediately make it active.
-	m_pStateManager->AddState<DefaultState>(true);
+	m_pEventManager = m_pContainer->Resolve<EventManager>();
+	m_pStateManager = m_pContainer->Resolve<StateManager>();
+	m_pInputManager = m_pContainer->Resolve<InputManager>();
+	m_pActionMap = m_pContainer->Resolve<ActionMap>();
+	m_pContext = m_pContainer->Resolve<ContextHandle>()->getInst();
+
+	// < The action map loaded on a worker, so what it skipped is reported here.
+	for (auto& problem : m_pActionMap->Problems()) { std::cout << "ActionMap: " << problem << ". \n"; }
+
+	gHitchDetector.Watch(m_pEventManager);
+
+	// < With a render thread, states only load and close on the main thread;
+	// * the simulation queues its transitions for it.
+	RenderPipeline* pPipeline = m_pContainer->Peek<RenderPipeline>();
+	bool bPipelined = (pPipeline != nullptr && pPipeline->IsPipelined());
+	if (bPipelined) { m_pStateManager->SetDeferred(true); }
+
+	// < Time every dispatch per event-type when asked to on the command-line,
+	// * appending a summary to the given file every few seconds, e.g.
+	// * "-eventstats events.txt".
+	std::string eventStatsPath = Leadwerks::System::GetProperty("eventstats");
+	if (eventStatsPath != "") {
+		m_pEventManager->EnableStats(true);
+		m_pEventManager->SetStatsDump(eventStatsPath, EVENT_STATS_INTERVAL);
+	}
+
+	// < Record or replay input when asked to on the command-line, e.g.
+	// * "-record bench.lwev" or "-replay bench.lwev".
+	std::string replayPath = Leadwerks::System::GetProperty("replay");
+	std::string recordPath = Leadwerks::System::GetProperty("record");
+
+	// < Only one of the two at a time; a replay is never recorded again.
+	if (replayPath != "" && recordPath != "") {
+		std::cout << "Cannot both replay and record an event log; ignoring \"-record\". \n";
+		recordPath = "";
+	}
+
+	if (replayPath != "" && !m_pEventManager->StartReplay(replayPath)) {
+		std::cout << "Failed to open event log \"" << replayPath << "\" for replay. \n";
+	}
+
+	if (recordPath != "" && !m_pEventManager->StartRecording(recordPath)) {
+		std::cout << "Failed to open event log \"" << recordPath << "\" for recording. \n";
+	}
+
+	// < Also sample input while the main thread waits when asked to, e.g.
+	// * "-inputhz 1000". Only a pipelined main thread waits, on the
+	// * simulation; otherwise the window is sampled once a frame regardless.
+	std::string inputHz = Leadwerks::System::GetProperty("inputhz");
+	if (inputHz != "" && !bPipelined) {
+		std::cout << "Input sampling needs \"-pipeline 1\"; ignoring \"-inputhz\". \n";
+	}
+	else if (inputHz != "" && !m_pInputManager->StartSampling((unsigned)(Leadwerks::String::Int(inputHz)))) {
+		std::cout << "Failed to start input sampling at \"" << inputHz << "\" Hz. \n";
+	}
+
+	// < Profile every frame when asked to on the command-line. "-profile 1"
+	// * draws a rolling summary over the scene, and "-trace trace.json"
+	// * captures the run for chrome://tracing, written at shutdown.
+	m_bShowProfile = (Leadwerks::String::Int(Leadwerks::System::GetProperty("profile")) != 0);
+	if (m_bShowProfile || Leadwerks::System::GetProperty("trace") != "") { gProfiler.SetEnabled(true); }
+	if (Leadwerks::System::GetProperty("trace") != "") { gProfiler.StartCapture(TRACE_SAMPLES); }
+
+	// < Write the last few frames to disk whenever one takes longer than the
+	// * given number of milliseconds, e.g. "-hitch 50 -hitchdir ./hitches".
+	std::string hitchMillis = Leadwerks::System::GetProperty("hitch");
+	if (hitchMillis != "") {
+		std::string hitchDir = Leadwerks::System::GetProperty("hitchdir");
+
+		gProfiler.SetEnabled(true);
+		gHitchDetector.Start((uint64_t)(Leadwerks::String::Int(hitchMillis)) * 1000, (hitchDir != "") ? hitchDir : ".");
+	}
+
+	// < Add our default state, preparing it in the background, and make it
+	// * active as soon as it is ready.
+	m_pStateManager->PreloadState<DefaultState>(true);
 
 	std::cout << "Application initialization completed successfully. \n";
 	
@@ -66,9 +186,35 @@ void App::Shutdown(void)
 
 void App::Dispose(void) 
 {
+	// < Write the input latency measured over the run when asked to on
+	// * the command-line, e.g. "-latency latency.txt".
+	std::string latencyPath = Leadwerks::System::GetProperty("latency");
+	if (latencyPath != "" && !gLatencyMonitor.DumpToFile(latencyPath)) {
+		std::cout << "Failed to write input latency to \"" << latencyPath << "\". \n";
+	}
+
+	std::string tracePath = Leadwerks::System::GetProperty("trace");
+	if (tracePath != "" && !gProfiler.WriteTrace(tracePath)) {
+		std::cout << "Failed to write profiler trace to \"" << tracePath << "\". \n";
+	}
+
+	gHitchDetector.Stop();
+	gHitchDetector.Watch(nullptr);
+
+	// < Close every state while the services they use are still alive; the
+	// * Container destroys those services, in reverse, once we return.
+	if (m_pStateManager != nullptr) { m_pStateManager->RemoveAllStates(); }
+
 	m_pEventManager = nullptr;
 	m_pInputManager = nullptr;
 	m_pStateManager = nullptr;
+	m_pActionMap = nullptr;
+	m_pContext = nullptr;
+
+	// < Destroy any cached resources, including those still in their grace period.
+	ResourceCache* pResourceCache = (m_pContainer != nullptr) ? m_pContainer->Peek<ResourceCache>() : nullptr;
+	if (pResourceCache != nullptr) { pResourceCache->Clear(); }
+	m_pContainer = nullptr;
 
 	// < Unregister any states that were registered during this
 	// * applications configure method. Order doesnt really
@@ -77,6 +223,31 @@ void App::Dispose(void)
 
 }
 
+void App::Poll(void)
+{
+	// < Queue whatever input the window has seen for the next Update.
+	if (m_pInputManager != nullptr) { m_pInputManager->Sample(); }
+
+}
+
+void App::Idle(void)
+{
+	if (m_pInputManager != nullptr) { m_pInputManager->SampleIdle(); }
+
+}
+
+bool App::HasTransitions(void) const
+{
+	return m_pStateManager != nullptr && m_pStateManager->HasTransitions();
+
+}
+
+void App::ApplyTransitions(void)
+{
+	if (m_pStateManager != nullptr) { m_pStateManager->ApplyTransitions(); }
+
+}
+
 void App::preUpdate(void) 
 { 
 	// < Call the StateManager's preUpdate.
@@ -86,14 +257,39 @@ void App::preUpdate(void)
 
 bool App::Update(float dt) 
 { 
-	// < Call EventManager's update. We allow it to process events 
-	// * for 200ms a frame.
-	if (m_pEventManager != nullptr) { m_pEventManager->Update(200); }
+	// < Measure how long the last frame took and let the EventManager adapt
+	// * its channel budgets to the headroom that was left.
+	uint64_t nowMicros = Timer::Micros();
+	if (m_nLastFrameMicros != 0 && m_pEventManager != nullptr)
+	{
+		long frameMicros = (long)(nowMicros - m_nLastFrameMicros);
+		m_pEventManager->AdaptBudgets(TARGET_FRAME_MICROS - frameMicros);
+	}
+	m_nLastFrameMicros = nowMicros;
+
+	// < Call EventManager's update. Each event channel is processed within
+	// * its own budget, highest priority first.
+	if (m_pEventManager != nullptr) { 
+		PROFILE_SCOPE("EventManager::Update");
+		m_pEventManager->Update(); 
+	}
 	
 	// < Call the InputManager's update.
-	if (m_pInputManager != nullptr) { m_pInputManager->Update(dt); } 
+	if (m_pInputManager != nullptr) { 
+		PROFILE_SCOPE("InputManager::Update");
+		m_pInputManager->Update(dt); 
+	} 
 
-	// < Call the StateManager's Update.
+	return true; 
+
+}
+
+bool App::FixedUpdate(float dt) 
+{ 
+	// < Call the StateManager's Update. This runs at the fixed tick rate,
+	// * so may be called several times in a frame, or not at all; the
+	// * InputManager hands each step only the movement it has not seen.
+	if (m_pInputManager != nullptr) { m_pInputManager->BeginStep(); }
 	if (m_pStateManager != nullptr) { m_pStateManager->Update(dt); }	
 
 	return true; 
@@ -131,6 +327,15 @@ void App::postRender(void)
 	// < Call the StateManager's postRender.
 	if (m_pStateManager != nullptr) { m_pStateManager->postRender(); }
 
+	// < Destroy any cached resources that have gone unused for too long.
+	// * Destroying them touches the scene, so it is done on the render side.
+	// < Peek rather than resolve, so a cache no state has used is never created.
+	ResourceCache* pResourceCache = (m_pContainer != nullptr) ? m_pContainer->Peek<ResourceCache>() : nullptr;
+	if (pResourceCache != nullptr) { 
+		PROFILE_SCOPE("ResourceCache::Update");
+		pResourceCache->Update(); 
+	}
+
 }
 
 void App::preDraw(void) 
@@ -148,6 +353,9 @@ void App::Draw(void)
 	// < Call the StateManager's Draw.
 	if (m_pStateManager != nullptr) { m_pStateManager->Draw(); }	
 
+	// < Draw the last frame's profile over everything else.
+	if (m_bShowProfile && m_pContext != nullptr) { gProfiler.DrawSummary(m_pContext, 8, 8); }
+
 	// < ---
 
 }
@@ -157,4 +365,7 @@ void App::postDraw(void)
 	// < Call the StateManager's postDraw.
 	if (m_pStateManager != nullptr) { m_pStateManager->postDraw(); }	
 
+	// < The first frame showing a state ends our startup.
+	if (m_pStateManager != nullptr && m_pStateManager->StackDepth() != 0) { gStartupReport.MarkFirstStateFrame(); }
+
 }
\ No newline at end of file
@@ -4,11 +4,14 @@
 #pragma once
 #include "Leadwerks.h"
 
+#include <cstdint>
+
 class Container;
 
 class EventManager;
 class InputManager;
 class StateManager;
+class ActionMap;
 
 class App {
 public:
@@ -20,9 +23,19 @@ public:
 	bool 			Start		(void);
 	void			Shutdown	(void);
 
+	// < Main thread only, as they read the window.
+	void			Poll		(void);			// < Once a frame, before it is updated.
+	void			Idle		(void);			// < Whenever a pipelined main thread waits.
+
+	// < Pipelined, state transitions are queued by the simulation and
+	// * applied on the main thread while the simulation waits.
+	bool			HasTransitions	(void) const;
+	void			ApplyTransitions(void);
+
 	void 			preUpdate	(void);
 	void 			postUpdate	(void);
 	bool 			Update		(float deltaTime);
+	bool 			FixedUpdate	(float stepTime);
 
 	void 			preRender	(void);
 	void 			postRender	(void);
@@ -41,6 +54,13 @@ private:
 	EventManager*   m_pEventManager;
 	InputManager*   m_pInputManager;
 	StateManager*   m_pStateManager;
+	ActionMap*      m_pActionMap;
+	Container*		m_pContainer;
+
+	Leadwerks::Context* m_pContext;		// < Used to draw the profile.
+	bool			m_bShowProfile;
+
+	uint64_t		m_nLastFrameMicros;
 
 }; // end class.
 
@@ -36,10 +36,10 @@ namespace Components
 	{
 		CLASS_TYPE(Appearance);
 		
-        std::string                   cModelPath;    /* The relative filepath to this components model. */
+        StringId                      cModelPath;    /* The relative filepath to this components model, interned. */
 
         /** The Appearance component constructor. */
-        Appearance(std::string modelPath = "", std::string cName = "") 
+        Appearance(StringId modelPath = StringId(), StringId cName = StringId()) 
 			: cModelPath(modelPath), Component(cName) { }     
 
 	} Appearance; // < end struct.
@@ -37,7 +37,7 @@ namespace Components
 		CameraHandle*                 pCamHndl;		/*!< A CameraHandle object. */
 
 		/** The Camera component constructor. */
-		Camera(CameraHandle* _pCamHndl = nullptr, std::string cName = "") 
+		Camera(CameraHandle* _pCamHndl = nullptr, StringId cName = StringId()) 
 			: pCamHndl(_pCamHndl), Component(cName) { }
 
 	} Camera; // < end struct.
@@ -33,7 +33,7 @@ namespace Components
 		using HasName::HasName;
 
 		/** The Components constructor. */
-		Component(std::string cName = "") : HasName(cName) { }
+		Component(StringId cName = StringId()) : HasName(cName) { }
 
 	} Component; // < end struct.
 
@@ -18,19 +18,19 @@
 
 #pragma once
 
-#include <string>
+#include "../Utilities/StringId.hpp"
 
 namespace Components
 {
 	/** An HasName component.
-	*  The HasName component provides access to a std::string name identifier.
+	*  The HasName component provides access to an interned name identifier.
 	*/
 	typedef struct HasName
 	{
-		std::string               cName;	/*!< std::string identifier. */
+		StringId                  cName;	/*!< Interned name identifier; compared as an integer. */
 
-		/** The HasName component constructor. */
-		HasName(std::string _cName = "") : cName(_cName) { }
+		/** The HasName component constructor. Names are registered, so one that collides with another is reported. */
+		HasName(StringId _cName = StringId()) : cName(_cName) { if (cName != StringId()) { cName.Register(); } }
 
 	} HasName; // < and struct.
 
@@ -36,7 +36,7 @@ namespace Components
 		uint64_t                      nMask;	/*!< A uint64_t bitmask. */
 
 		/** The Input component constructor.*/
-		Input(std::string cName = "") : nMask(INPUT_NONE) { }
+		Input(StringId cName = StringId()) : nMask(INPUT_NONE), Component(cName) { }
 
 	} Input; // < end struct.
 
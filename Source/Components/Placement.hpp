@@ -42,7 +42,7 @@ namespace Components
 		Placement(Leadwerks::Vec3 _vPos = Leadwerks::Vec3(0.0f, 0.0f, 0.0f)
 				, Leadwerks::Vec3 _vRot = Leadwerks::Vec3(0.0f, 0.0f, 0.0f)
 				, Leadwerks::Vec3 _vSca = Leadwerks::Vec3(1.0f, 1.0f, 1.0f)
-				, std::string cName = "")
+				, StringId cName = StringId())
 		: vPos(_vPos), vRot(_vRot), vSca(_vSca), Component(cName) { }
 
 	} Placement; // < end struct.
@@ -35,7 +35,7 @@ namespace Components
 		Leadwerks::Vec3                   vVel;	/*!< A Leadwerks::Vec3 representing a movement vector in 3D space. */
 
 		/* The Velocity component constructor. */
-		Velocity(Leadwerks::Vec3 _vVel = Leadwerks::Vec3(0.0f, 0.0f, 0.0f), std::string cName = "") 
+		Velocity(Leadwerks::Vec3 _vVel = Leadwerks::Vec3(0.0f, 0.0f, 0.0f), StringId cName = StringId()) 
 			: vVel(_vVel), Component(cName) { }
 
 	} Velocity; // < end struct.
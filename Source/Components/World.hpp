@@ -38,12 +38,12 @@ namespace Components
 		CLASS_TYPE(World);
 
 		typedef void*                                     InstPtr;			  /*!< A defined type aliasing a void. */
-		typedef std::pair<uint64_t, std::string>          CompKey;	          /*!< A defined type aliasing a std::pair used as the key for the ComponentMap. */
+		typedef std::pair<uint64_t, StringId>             CompKey;	          /*!< A defined type aliasing a std::pair used as the key for the ComponentMap. */
 		typedef std::map <CompKey, InstPtr>               ComponentMap;	      /*!< A defined type aliasing a std::map used to store components by entity relation and their containing collection. */
 
 	public:
 
-                                                          World(std::string cName = "");                                          /** The World component constructor. */
+                                                          World(StringId cName = StringId());                                     /** The World component constructor. */
                                                           ~World(void);                                                           /** The World component destructor. */
 		
 		uint64_t                                          CreateEntity(World* pWorld);                                            /** Creates a new entity contained within the given World. */
@@ -52,7 +52,7 @@ namespace Components
 		
 		template <typename T> void                        AddComponent(World* pWorld, uint64_t entity, T val);                    /** Adds the given Component of type T to the given World and associates the component with the given entity. */
 		
-		template <typename T> uint64_t                    RemoveComponent(World* pWorld, uint64_t entity, std::string cName);     /** Attempts to remove the given Component of type T from the given World that is associated with the given entity of the given name. */
+		template <typename T> uint64_t                    RemoveComponent(World* pWorld, uint64_t entity, StringId cName);        /** Attempts to remove the given Component of type T from the given World that is associated with the given entity of the given name. */
         void                                              RemoveComponents(World* pWorld, uint64_t entity);
 
 		uint64_t&                                         Get(uint64_t entity);                                                   /** Returns a reference to the given entities Component bitmask. */
@@ -61,6 +61,8 @@ namespace Components
 				
 		template <typename T> std::vector<T>*             GetComponents(World* pWorld, uint64_t entity);                          /** Returns a Component collection of type T assocated with the given entity. */
 
+		template <typename T, typename F> void            ForEachComponent(F onComponent);                                        /** Calls onComponent with every Component of type T in the World, in a single pass. */
+
 		uint64_t& operator [] (int index)
 		{
 			return m_entityMasks[index];
@@ -90,8 +92,7 @@ namespace Components
 	template <typename T>
 	World::CompKey World::MakeComponentKey(uint64_t entity)
 	{
-		std::string type = T::ClassType();
-		auto key = std::make_pair(entity, type);
+		auto key = std::make_pair(entity, T::ClassId());
 
 		return key;
 	}
@@ -99,8 +100,7 @@ namespace Components
 	template <typename T>
 	void World::AddComponent(World* pWorld, uint64_t entity, T val)
 	{
-		std::string type = T::ClassType();
-		auto key = std::make_pair(entity, type);
+		auto key = std::make_pair(entity, T::ClassId());
 
 		val.nId = entity;
 		
@@ -115,27 +115,26 @@ namespace Components
 	}
 
 	template <typename T>
-	uint64_t World::RemoveComponent(World* pWorld, uint64_t entity, std::string cName)
+	uint64_t World::RemoveComponent(World* pWorld, uint64_t entity, StringId cName)
 	{
 		uint64_t numRemoved = 0;
 
-		auto iter = FetchInternal<T>(pWorld);
-		if (iter == pWorld->m_components.end()) { return; }
+		auto components = pWorld->Fetch<T>(pWorld, entity);
+		if (components == nullptr) { return numRemoved; }
 
-		auto components = static_cast<std::vector<T>*>(iter->second);
-		auto it = components.begin();
-		while (it != components.end())
+		auto it = components->begin();
+		while (it != components->end())
 		{
-			if (it.nId == entity)
+			// < Names are interned, so this is an integer compare.
+			if (it->nId == entity && it->cName == cName)
 			{
-				if (cName.compare(it.cName) == 0) 
-				{
-					it = components.erase(it); 
-					numRemoved += 1;
-				}
+				it = components->erase(it);
+				numRemoved += 1;
+			}
+			else
+			{
+				it++;
 			}
-
-			it++;
 		}
 
 		return numRemoved;
@@ -145,8 +144,7 @@ namespace Components
 	template <typename T>
 	std::vector<T>* World::Fetch(World* pWorld, uint64_t entity)
 	{
-		std::string type = T::ClassType();
-		auto key = std::make_pair(entity, type);
+		auto key = std::make_pair(entity, T::ClassId());
 
 		auto it = pWorld->m_components.find(key);
 		if (it != pWorld->m_components.end()) { return static_cast<std::vector<T>*>(it->second); }
@@ -158,8 +156,7 @@ namespace Components
 	template <typename T>
 	World::ComponentMap::iterator World::FetchInternal(World* pWorld, uint64_t entity)
 	{
-		std::string type = T::ClassType();
-		auto key = std::make_pair(entity, type);
+		auto key = std::make_pair(entity, T::ClassId());
 
 		return pWorld->m_components.find(key);
 
@@ -168,13 +165,27 @@ namespace Components
 	template <typename T>
 	std::vector<T>* World::GetComponents(World* pWorld, uint64_t entity)
 	{
-		std::string type = T::ClassType();
-		auto key = std::make_pair(entity, type);
+		auto key = std::make_pair(entity, T::ClassId());
 
 		return static_cast<std::vector<T>*>( pWorld->m_components.at(key) );
 		
 	}
 
+	template <typename T, typename F>
+	void World::ForEachComponent(F onComponent)
+	{
+		StringId classId = T::ClassId();
+
+		for (auto it = m_components.begin(); it != m_components.end(); it++)
+		{
+			if (it->first.second != classId) { continue; }
+
+			auto components = static_cast<std::vector<T>*>(it->second);
+			for (auto comp = components->begin(); comp != components->end(); comp++) { onComponent(*comp); }
+		}
+
+	}
+
 } // < end namespace.
 
 #endif _WORLD_HPP_
\ No newline at end of file
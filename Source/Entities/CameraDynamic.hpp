@@ -13,7 +13,7 @@
 
     Functions: 1. static inline uint64_t Create(Components::World* pWorld, Leadwerks::Vec3 vPos, Leadwerks::Vec3 vRot, CameraHandle* pCameraHndl);
     
-               2. static void Update(Components::World* pWorld, float dt); 
+               2. static void Update(InputManager* pInputMgr, RenderPipeline* pPipeline, Components::World* pWorld, float dt); 
 
 ---------------------------------------------------------*/
 
@@ -23,6 +23,7 @@
 #pragma once
 #include "Leadwerks.h"
 
+#include "../Services/RenderPipeline.hpp"
 #include "../Utilities/CameraHandle.hpp"
 
 #include "../Components/ComponentDictionary.hpp"
@@ -59,15 +60,21 @@ namespace Entities
 			pWorld->AddComponent<Components::Velocity>(pWorld, entity, Components::Velocity());
 			pWorld->AddComponent<Components::Camera>(pWorld, entity, Components::Camera(pCameraHndl));
 
+			// < A headless camera has nothing to place.
 			auto cam = pCameraHndl->getInst();
-			cam->SetRotation(vRot, false);
-			cam->SetPosition(vPos, true);
+			if (cam != nullptr) {
+				cam->SetRotation(vRot, false);
+				cam->SetPosition(vPos, true);
+			}
 
 			return entity;
 		}
 
-		static void Update(InputManager* pInputMgr, Components::World* pWorld, float dt) 
+		static void Update(InputManager* pInputMgr, RenderPipeline* pPipeline, Components::World* pWorld, float dt) 
 		{
+			// < Every camera reads the same snapshot of the mouse.
+			MouseState mouse = pInputMgr->Mouse();
+
 			// < Get a collection of entities that are of type cameraDynamic.
 			auto entities = pWorld->GetEntities(pWorld, MASK_CAMERA_DYNAMIC);
 			
@@ -92,12 +99,12 @@ namespace Entities
 
 				// < Are we rotating the camera left or right?
                 if ( (bool(inputMask & INPUT_ROTATE_LEFT | INPUT_ROTATE_RIGHT)) ) {
-                    dY = (((bool(inputMask & INPUT_ROTATE_RIGHT)) - (bool(inputMask & INPUT_ROTATE_LEFT))) + pInputMgr->DeltaX())  * dt * 0.75f;
+                    dY = (((bool(inputMask & INPUT_ROTATE_RIGHT)) - (bool(inputMask & INPUT_ROTATE_LEFT))) + mouse.fDeltaX)  * dt * 0.75f;
                 }
 
 				// < Are we tilting the camera up or down?
                 if ( (bool(inputMask & INPUT_ROTATE_UP |INPUT_ROTATE_DOWN)) ) {
-                    dX = (((bool(inputMask & INPUT_ROTATE_UP)) - (bool(inputMask & INPUT_ROTATE_DOWN))) + pInputMgr->DeltaY())  * dt * 0.75f;
+                    dX = (((bool(inputMask & INPUT_ROTATE_UP)) - (bool(inputMask & INPUT_ROTATE_DOWN))) + mouse.fDeltaY)  * dt * 0.75f;
                 }
 
 				// < Are we looking to move the camera?
@@ -111,11 +118,12 @@ namespace Entities
 								
                 placementComponent.vRot += Leadwerks::Vec3(dX, dY, 0.0f);
 
-				// < Set the camera's rotation and position.
+				// < Set the camera's rotation and position. The camera may be
+				// * in the middle of being rendered, so the pipeline moves it.
 				auto cam = cameraComponent.pCamHndl->getInst();
 
-				cam->SetRotation(placementComponent.vRot, false);
-				cam->Move(velocityComponent.vVel, true);
+				pPipeline->Submit(RenderCommand::SetRotation(cam, placementComponent.vRot, false));
+				pPipeline->Submit(RenderCommand::Move(cam, velocityComponent.vVel, true));
 
 				// < ---
 
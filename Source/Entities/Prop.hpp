@@ -43,18 +43,18 @@ namespace Entities
 
             // < Load and read the given script.
             auto table = LuaTable::fromFile(cScriptPath.c_str());
-            auto name = table["name"].get<std::string>();
+            auto name = StringId::Intern(table["name"].get<std::string>());
 			auto vPos = table["pos"].get<Leadwerks::Vec3>();
 			auto vRot = table["rot"].get<Leadwerks::Vec3>();
 			auto vSca = table["sca"].get<Leadwerks::Vec3>();
-			auto path = table["modelPath"].get<std::string>();
+			auto path = StringId::Intern(table["modelPath"].get<std::string>());
 			
             // < Create required components.
             pWorld->AddComponent<Components::Placement>(pWorld, entity, Components::Placement(vPos, vRot, vSca, name));
             pWorld->AddComponent<Components::Appearance>(pWorld, entity, Components::Appearance(path, name));
             
             // < Create associated model and initialize.
-            auto pModel = Leadwerks::Model::Load(path);
+            auto pModel = Leadwerks::Model::Load(path.c_str());
             pModel->SetScale(vSca);
             pModel->SetRotation(vRot, false);
             pModel->SetPosition(vPos, true);
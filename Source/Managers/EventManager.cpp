@@ -4,139 +4,455 @@
 #include "EventManager.hpp"
 #include "..\Utilities\Delegate.hpp"
 #include "..\Utilities\Event.hpp"
+#include "..\Utilities\Timer.hpp"
 
+#include <cassert>
+#include <fstream>
 #include <list>
 #include <map>
 
-EventManager::EventManager() 
-	: m_nActiveQueue(0) {
-
+/* Default budget ranges per channel, in microseconds. Input is kept small but is processed
+   - first; background work soaks up whatever headroom the frame leaves behind. */
+static const unsigned long s_defaultMinBudget[NUM_EVENT_CHANNELS] = { 1000, 1000, 250 };
+static const unsigned long s_defaultMaxBudget[NUM_EVENT_CHANNELS] = { 4000, 6000, 4000 };
+
+EventManager::EventManager(Clock* pClock)
+	: m_pClock((pClock != nullptr) ? pClock : new LeadwerksClock()), m_bOwnsClock(pClock == nullptr),
+	m_timers(m_pClock->Millis()), m_bStatsEnabled(false), m_nStatsDumpInterval(0), m_nNextStatsDump(0),
+	m_nFrame(0), m_nDispatched(0) {
+
+	for (int i = 0; i < NUM_EVENT_CHANNELS; i++) {
+		m_channels[i].id = (EventChannel)i;
+		m_channels[i].nActiveQueue = 0;
+		m_channels[i].nUsedMicros = 0;
+		SetBudget((EventChannel)i, s_defaultMinBudget[i], s_defaultMaxBudget[i]);
+	}
 }
 
 EventManager::~EventManager() {
+	if (m_bOwnsClock) { SAFE_DELETE(m_pClock); }
+}
+
+bool EventManager::Update(void) {
+	bool allFlushed = true;
+
+	m_nFrame += 1;
+
+	/* Feed back the recorded input of this frame, if replaying. */
+	if (IsReplaying()) { ReplayFrame(); }
+
+	/* Queue any scheduled events that expired since the last update. */
+	m_timers.Advance(m_pClock->Millis(), [this](const ScheduledEvent& scheduled, TimerHandle) {
+		QueueEvent(*scheduled.pEvent, scheduled.channel);
+	});
+
+	/* Append the periodic instrumentation summary, if one is due. */
+	if (m_nStatsDumpInterval != 0 && m_pClock->Millis() >= m_nNextStatsDump) {
+		std::ofstream out(m_statsDumpPath.c_str(), std::ios::app);
+		if (out.is_open()) { DumpStats(out); }
+		m_nNextStatsDump = m_pClock->Millis() + m_nStatsDumpInterval;
+	}
+
+	/* Input queued on a Bus last frame is delivered first, where it was when it went through
+	   - the input channel, so listeners still see it a frame later and ahead of gameplay. */
+	if (m_inputDispatch.IsBound()) { m_inputDispatch.Invoke(); }
+
+	/* Channels are processed in priority order. Time left over by a channel is handed down to
+	   - the next one, so an idle input channel lets gameplay and background work catch up. */
+	unsigned long carriedMicros = 0;
+	for (int i = 0; i < NUM_EVENT_CHANNELS; i++) {
+		EventChannelData& channel = m_channels[i];
+
+		unsigned long budget = channel.nBudgetMicros;
+		if (budget != EventManager::KINFINITE) { budget += carriedMicros; }
+
+		allFlushed &= ProcessChannel(channel, budget);
+
+		carriedMicros = (budget != EventManager::KINFINITE && channel.nUsedMicros < budget) ? (budget - channel.nUsedMicros) : 0;
+	}
+
+	return allFlushed;
+}
+
+void EventManager::AdaptBudgets(long nHeadroomMicros) {
+	/* Only half of the measured headroom is handed out (or taken back) per frame to keep the
+	   - budgets from oscillating. Spare time goes to the highest priority channel that can still
+	   - grow; an overrun is taken from the lowest priority channel first, so input only shrinks
+	   - once gameplay and background are at their minimum. */
+	long remaining = nHeadroomMicros / 2;
+	int step = (remaining > 0) ? 1 : -1;
+	int i = (remaining > 0) ? 0 : (NUM_EVENT_CHANNELS - 1);
+
+	for (; i >= 0 && i < NUM_EVENT_CHANNELS && remaining != 0; i += step) {
+		EventChannelData& channel = m_channels[i];
+		if (channel.nBudgetMicros == EventManager::KINFINITE) { continue; }
+
+		long budget = (long)channel.nBudgetMicros + remaining;
+		if (budget < (long)channel.nMinBudgetMicros) { budget = (long)channel.nMinBudgetMicros; }
+		if (budget > (long)channel.nMaxBudgetMicros) { budget = (long)channel.nMaxBudgetMicros; }
+
+		remaining -= (budget - (long)channel.nBudgetMicros);
+		channel.nBudgetMicros = (unsigned long)budget;
+	}
+}
+
+void EventManager::SetBudget(EventChannel channel, unsigned long nMinMicros, unsigned long nMaxMicros) {
+	assert(channel >= 0 && channel < NUM_EVENT_CHANNELS);
+	assert(nMinMicros <= nMaxMicros);
+
+	EventChannelData& data = m_channels[channel];
+	data.nMinBudgetMicros = nMinMicros;
+	data.nMaxBudgetMicros = nMaxMicros;
+	data.nBudgetMicros = nMinMicros;
+}
+
+unsigned long EventManager::Budget(EventChannel channel) const {
+	assert(channel >= 0 && channel < NUM_EVENT_CHANNELS);
+	return m_channels[channel].nBudgetMicros;
+}
+
+size_t EventManager::Backlog(EventChannel channel) const {
+	assert(channel >= 0 && channel < NUM_EVENT_CHANNELS);
+	const EventChannelData& data = m_channels[channel];
+	return data.queues[data.nActiveQueue].size();
+}
 
+TimerHandle EventManager::ScheduleEvent(BaseEventData& pEvent, unsigned long nDelayMillis, EventChannel channel) {
+	assert(channel >= 0 && channel < NUM_EVENT_CHANNELS);
+	return m_timers.Schedule(ScheduledEvent(&pEvent, channel), nDelayMillis);
 }
 
-bool EventManager::Update(unsigned long nMaxMillis) {
-	unsigned long currMs = Leadwerks::Time::GetCurrent();
-	unsigned long maxMs = ((nMaxMillis == EventManager::KINFINITE) ? (EventManager::KINFINITE) : (currMs + maxMs));
+TimerHandle EventManager::ScheduleRepeating(BaseEventData& pEvent, unsigned long nIntervalMillis, EventChannel channel) {
+	assert(channel >= 0 && channel < NUM_EVENT_CHANNELS);
+	assert(nIntervalMillis > 0);
+	return m_timers.Schedule(ScheduledEvent(&pEvent, channel), nIntervalMillis, nIntervalMillis);
+}
+
+bool EventManager::CancelScheduled(TimerHandle handle) {
+	return m_timers.Cancel(handle);
+}
+
+size_t EventManager::ScheduledCount(void) const {
+	return m_timers.Size();
+}
+
+bool EventManager::ProcessChannel(EventChannelData& channel, unsigned long nBudgetMicros) {
+	uint64_t startUs = Timer::Micros();
+	uint64_t currUs = startUs;
 
 	/* Swap active queue, clear new queue, after swap */
-	int queueToProcess = this->m_nActiveQueue;
-	m_nActiveQueue = (this->m_nActiveQueue + 1) % NUM_QUEUES;
-	m_queues[m_nActiveQueue].clear();
+	int queueToProcess = channel.nActiveQueue;
+	channel.nActiveQueue = (channel.nActiveQueue + 1) % NUM_QUEUES;
+	channel.queues[channel.nActiveQueue].clear();
 
 	/* Process the queue */
-	while (!m_queues[queueToProcess].empty()) {
-		BaseEventData* pEvent = m_queues[queueToProcess].front();
-		m_queues[queueToProcess].pop_front();
-
-		EventType eventType = pEvent->ObjectType();
-
-		/* Find delegate functions registered for this event */
-		auto find = m_eventListeners.find(eventType);
-		if (find != m_eventListeners.end()) {
-			const EventListenerList& eventListeners = find->second;
-
-			/* Call each listener */
-			EventListenerList::const_iterator it = eventListeners.begin();
-			while (it != eventListeners.end()) {	
-				if (&it != nullptr) {
-					it->Invoke(pEvent);					
-				}
-				it++;
-			}
-		}
+	EventQueue& queue = channel.queues[queueToProcess];
+	while (!queue.empty()) {
+		BaseEventData* pEvent = queue.front();
+		queue.pop_front();
+
+		Dispatch(pEvent, channel.id, true);
 
 		/* Check to see if processing time ran out */
-		currMs = Leadwerks::Time::GetCurrent();
-		if (nMaxMillis != EventManager::KINFINITE && currMs >= maxMs) {
+		currUs = Timer::Micros();
+		if (nBudgetMicros != EventManager::KINFINITE && (currUs - startUs) >= nBudgetMicros) {
 			break;
 		}
 	}
 
-	/* If all events could not be processed this frame, push the remaining events to the new
-	   - active queue.*/
-	bool queueFlushed = (m_queues[queueToProcess].empty());
+	channel.nUsedMicros = (unsigned long)(currUs - startUs);
+
+	/* If all events could not be processed this frame, move the remaining events to the front
+	   - of the new active queue so they keep their order ahead of anything queued since. */
+	bool queueFlushed = queue.empty();
 	if (!queueFlushed) {
-		while (!m_queues[queueToProcess].empty()) {
-			BaseEventData* pEvent = m_queues[queueToProcess].back();
-			m_queues[queueToProcess].pop_back();
-			m_queues[m_nActiveQueue].push_front(pEvent);
-		}
+		EventQueue& activeQueue = channel.queues[channel.nActiveQueue];
+		activeQueue.splice(activeQueue.begin(), queue);
 	}
 
 	return queueFlushed;
 }
 
-void EventManager::Render() {
+bool EventManager::Dispatch(BaseEventData* pEvent, EventChannel channel, bool bQueued) {
+	EventType eventType = pEvent->ObjectId();
+
+	/* Find delegate functions registered for this event */
+	auto find = m_eventListeners.find(eventType);
+	if (find == m_eventListeners.end()) {
+		return false;
+	}
+
+	/* A targeted event only reaches its target's listeners, alongside those of the whole
+	   - type; every other target's listeners are never visited. */
+	EventListeners& listeners = find->second;
+	EventListenerList& broadcast = listeners.broadcast;
+	EventListenerList* pTargeted = nullptr;
+
+	if (pEvent->IsTargeted()) {
+		auto target = find->second.targeted.find(pEvent->Target());
+		if (target != find->second.targeted.end() && !target->second.empty()) { pTargeted = &target->second; }
+	}
+
+	if (broadcast.empty() && pTargeted == nullptr) {
+		return false;
+	}
+
+	m_nDispatched.fetch_add(1, std::memory_order_relaxed);
+
+	if (m_recorder.IsOpen()) { m_recorder.Record(m_nFrame, (uint8_t)(channel), *pEvent); }
+
+	if (!m_bStatsEnabled) {
+		/* Call each listener */
+		if (pTargeted != nullptr) { pTargeted->Invoke(pEvent); }
+		broadcast.Invoke(pEvent);
+
+		if (pTargeted != nullptr) { DropEmptyTarget(listeners, pEvent->Target()); }
+
+		return true;
+	}
+
+	EventTypeStats& stats = m_stats[eventType];
+
+	if (bQueued) {
+		stats.nDispatched += 1;
+		stats.latency.Add(Timer::Micros() - pEvent->m_nQueuedMicros);
+	}
+	else {
+		stats.nTriggered += 1;
+	}
+
+	if (pTargeted != nullptr) { Invoke(*pTargeted, pEvent, &stats); }
+	Invoke(broadcast, pEvent, &stats);
+
+	if (pTargeted != nullptr) { DropEmptyTarget(listeners, pEvent->Target()); }
 
+	return true;
 }
 
-void EventManager::Draw() {
+void EventManager::DropEmptyTarget(EventListeners& listeners, EventTarget target) {
+	/* Listeners that unsubscribe while their target is dispatched to are only unbound until the
+	   - walk completes, so RemoveListener leaves the bucket; it is dropped here once empty, unless
+	   - an outer dispatch is still walking it. */
+	auto bucket = listeners.targeted.find(target);
+	if (bucket != listeners.targeted.end() && bucket->second.empty() && !bucket->second.IsInvoking()) {
+		listeners.targeted.erase(bucket);
+	}
+}
+
+void EventManager::Invoke(EventListenerList& listeners, BaseEventData* pEvent, EventTypeStats* pStats) {
+	if (pStats == nullptr) {
+		listeners.Invoke(pEvent);
+		return;
+	}
+
+	uint64_t startUs = Timer::Micros();
+
+	/* Call each listener, timing every invocation. Listeners removed meanwhile are only
+	   - unbound until the walk completes. */
+	listeners.BeginInvoke();
+	for (size_t i = 0; i < listeners.Size(); i++) {
+		EventListenerDelegate listener = listeners[i];
+		if (!listener.IsBound()) { continue; }
+
+		listener.Invoke(pEvent);
 
+		uint64_t endUs = Timer::Micros();
+		pStats->listeners[listener.Target()].Add(endUs - startUs);
+		startUs = endUs;
+	}
+	listeners.EndInvoke();
+}
+
+void EventManager::EnableStats(bool bEnable) {
+	m_bStatsEnabled = bEnable;
+}
+
+const EventTypeStats* EventManager::GetStats(const EventType& type) const {
+	auto find = m_stats.find(type);
+	return (find != m_stats.end()) ? &find->second : nullptr;
+}
+
+const EventManager::EventStatsMap& EventManager::GetAllStats(void) const {
+	return m_stats;
+}
+
+void EventManager::ResetStats(void) {
+	m_stats.clear();
 }
 
-bool EventManager::AddListener(const EventListenerDelegate& eventDelegate, const EventType& type) {
-	EventListenerList& eventListenerList = m_eventListeners[type];
-	EventListenerList::iterator it = eventListenerList.begin();
-	while (it != eventListenerList.end()) {
-		if (*it == eventDelegate) {
-			return false;
+void EventManager::DumpStats(std::ostream& out) const {
+	out << "EventManager statistics @ " << m_pClock->Millis() << "ms\n";
+
+	for (int i = 0; i < NUM_EVENT_CHANNELS; i++) {
+		out << "  channel " << i << ": budget " << m_channels[i].nBudgetMicros << "us, used "
+			<< m_channels[i].nUsedMicros << "us, backlog " << Backlog((EventChannel)i) << "\n";
+	}
+
+	auto iter = m_stats.begin();
+	while (iter != m_stats.end()) {
+		const EventTypeStats& stats = iter->second;
+
+		out << "  " << iter->first.c_str()
+			<< ": queued " << stats.nQueued
+			<< ", dispatched " << stats.nDispatched
+			<< ", triggered " << stats.nTriggered
+			<< ", aborted " << stats.nAborted
+			<< ", latency p50 " << stats.latency.Percentile(50.0f) << "us"
+			<< " p99 " << stats.latency.Percentile(99.0f) << "us"
+			<< " max " << stats.latency.Max() << "us\n";
+
+		auto listener = stats.listeners.begin();
+		while (listener != stats.listeners.end()) {
+			const ListenerStats& cost = listener->second;
+
+			out << "    listener " << listener->first.first << "/" << (const void*)(listener->first.second)
+				<< ": calls " << cost.nCalls
+				<< ", total " << cost.nTotalMicros << "us"
+				<< ", max " << cost.nMaxMicros << "us\n";
+
+			listener++;
 		}
-		it++;
+
+		iter++;
 	}
+}
+
+void EventManager::SetStatsDump(const std::string& path, unsigned long nIntervalMillis) {
+	m_statsDumpPath = path;
+	m_nStatsDumpInterval = nIntervalMillis;
+	m_nNextStatsDump = m_pClock->Millis() + nIntervalMillis;
+}
+
+bool EventManager::StartRecording(const std::string& path) {
+	assert(!IsReplaying());	// Cannot record while replaying.
+
+	return m_recorder.Open(path);
+}
+
+void EventManager::StopRecording(void) {
+	m_recorder.Close();
+}
+
+bool EventManager::IsRecording(void) const {
+	return m_recorder.IsOpen();
+}
+
+bool EventManager::StartReplay(const std::string& path) {
+	StopRecording();
+
+	if (!m_player.Open(path)) { return false; }
+
+	/* Events are created by handle while replaying, rather than by name. */
+	m_player.ResolveTypes([](const std::string& type) { return gEventFactory.Resolve(type); });
 
-	eventListenerList.push_back(eventDelegate);
 	return true;
 }
 
-bool EventManager::RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type) {
-	bool success = false;
+void EventManager::StopReplay(void) {
+	m_player.Close();
+}
 
-	auto find = m_eventListeners.find(type);
-	if (find != m_eventListeners.end()) {
-		EventListenerList& listeners = find->second;
-		EventListenerList::iterator it = listeners.begin();
-		while (it != listeners.end()) {
-			if (*it == eventDelegate) {
-				listeners.erase(it);
-				success = true;
-				break;
-			}
-			it++;
-		}
+bool EventManager::IsReplaying(void) const {
+	return m_player.IsOpen();
+}
+
+void EventManager::RecordEvent(BaseEventData& pEvent, EventChannel channel) {
+	if (m_recorder.IsOpen()) { m_recorder.Record(m_nFrame, (uint8_t)(channel), pEvent); }
+}
+
+void EventManager::SetInputDispatch(const InputDispatchDelegate& dispatch) {
+	m_inputDispatch = dispatch;
+}
+
+uint64_t EventManager::DispatchCount(void) const {
+	return m_nDispatched.load(std::memory_order_relaxed);
+}
+
+uint32_t EventManager::Frame(void) const {
+	return m_nFrame;
+}
+
+void EventManager::ReplayFrame(void) {
+	/* Only input is replayed; everything downstream of it is regenerated by the
+	   - application itself, exactly as it was while recording. */
+	m_player.Play(m_nFrame, [this](const RecordedEvent& recorded) {
+		if (recorded.nChannel != EVENT_CHANNEL_INPUT) { return; }
+
+		BaseEventData* pEvent = (recorded.handle != INVALID_FACTORY_HANDLE)
+			? gEventFactory.Create(recorded.handle) : gEventFactory.Create(recorded.type);
+		if (pEvent == nullptr) { return; }
+
+		recorded.Apply(*pEvent);
+		TriggerEvent(*pEvent, EVENT_CHANNEL_INPUT);
+
+		gEventFactory.Destroy(pEvent);
+	});
+
+	if (m_player.Finished()) {
+		std::cout << "Event replay finished at frame " << m_nFrame << ". \n";
+		StopReplay();
 	}
+}
+
+void EventManager::Render() {
+
+}
+
+void EventManager::Draw() {
 
-	return success;
 }
 
-bool EventManager::TriggerEvent(BaseEventData& pEvent) {
-	bool processed = false;
+bool EventManager::AddListener(const EventListenerDelegate& eventDelegate, const EventType& type, EventTarget target) {
+	EventListeners& listeners = m_eventListeners[type];
 
-	auto find = m_eventListeners.find(pEvent.ObjectType());
+	if (target == EVENT_TARGET_NONE) {
+		return listeners.broadcast.Add(eventDelegate);
+	}
+
+	return listeners.targeted[target].Add(eventDelegate);
+}
+
+bool EventManager::RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type, EventTarget target) {
+	bool success = false;
+
+	auto find = m_eventListeners.find(type);
 	if (find != m_eventListeners.end()) {
-		EventListenerList& eventListenerList = find->second;
-		EventListenerList::const_iterator it = eventListenerList.begin();
-		while (it != eventListenerList.end()) {	
-			if (&it != nullptr) {
-				it->Invoke(&pEvent);
-				processed = true;
+		if (target == EVENT_TARGET_NONE) {
+			success = find->second.broadcast.Remove(eventDelegate);
+		}
+		else {
+			auto bucket = find->second.targeted.find(target);
+			if (bucket != find->second.targeted.end()) {
+				success = bucket->second.Remove(eventDelegate);
+
+				/* Drop the bucket with its last listener, so targets that come and go (such as
+				   - destroyed entities) do not accumulate. */
+				if (bucket->second.empty()) { find->second.targeted.erase(bucket); }
 			}
-			it++;
 		}
 	}
 
-	return processed;
+	return success;
 }
 
-bool EventManager::QueueEvent(BaseEventData& pEvent) {
+bool EventManager::TriggerEvent(BaseEventData& pEvent, EventChannel channel) {
+	return Dispatch(&pEvent, channel, false);
+}
+
+bool EventManager::QueueEvent(BaseEventData& pEvent, EventChannel channel) {
 	if (&pEvent == nullptr)
 		return false;
 
-	auto find = m_eventListeners.find(pEvent.ObjectType());
+	assert(channel >= 0 && channel < NUM_EVENT_CHANNELS);
+
+	auto find = m_eventListeners.find(pEvent.ObjectId());
 	if (find != m_eventListeners.end()) {
-		m_queues[m_nActiveQueue].push_back(&pEvent);
+		EventChannelData& data = m_channels[channel];
+		data.queues[data.nActiveQueue].push_back(&pEvent);
+
+		pEvent.m_nQueuedMicros = Timer::Micros();
+		if (m_bStatsEnabled) { m_stats[pEvent.ObjectId()].nQueued += 1; }
+
 		return true;
 	}
 	else {
@@ -149,17 +465,20 @@ bool EventManager::AbortEvent(const EventType& type, bool bAll) {
 
 	EventMap::iterator find = m_eventListeners.find(type);
 	if (find != m_eventListeners.end()) {
-		EventQueue& eventQueue = m_queues[m_nActiveQueue];
-		EventQueue::const_iterator it = eventQueue.begin();
-		while (it != eventQueue.end()) {
-			auto thisIt = it;
-			if ((*thisIt)->ObjectType() == type) {
-				eventQueue.erase(thisIt);
-				success = true;
-				if (!bAll) { break; }
+		for (int i = 0; i < NUM_EVENT_CHANNELS; i++) {
+			EventQueue& eventQueue = m_channels[i].queues[m_channels[i].nActiveQueue];
+			EventQueue::iterator it = eventQueue.begin();
+			while (it != eventQueue.end()) {
+				if ((*it)->ObjectId() == type) {
+					if (m_bStatsEnabled) { m_stats[type].nAborted += 1; }
+					it = eventQueue.erase(it);
+					success = true;
+					if (!bAll) { return success; }
+				}
+				else {
+					it++;
+				}
 			}
-
-			it++;
 		}
 	}
 
@@ -15,27 +15,59 @@
                  support, driving a subscription model
                  for event delegation.
 
-    Functions: 1. bool AddListener(const EventListenerDelegate& eventDelegate, const EventType& type);
+    Functions: 1. bool AddListener(const EventListenerDelegate& eventDelegate, const EventType& type, EventTarget target = EVENT_TARGET_NONE);
     
-               2. bool RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type);
+               2. bool RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type, EventTarget target = EVENT_TARGET_NONE);
                
-               3. bool TriggerEvent(BaseEventData& pEvent);
+               3. bool TriggerEvent(BaseEventData& pEvent, EventChannel channel = EVENT_CHANNEL_GAMEPLAY);
                
-               4. bool QueueEvent(BaseEventData& pEvent);
+               4. bool QueueEvent(BaseEventData& pEvent, EventChannel channel = EVENT_CHANNEL_GAMEPLAY);
                
                5. bool AbortEvent(const EventType& type, bool bAll = false);
+
+               6. void AdaptBudgets(long nHeadroomMicros);
+
+               7. size_t Backlog(EventChannel channel);
+
+               8. TimerHandle ScheduleEvent(BaseEventData& pEvent, unsigned long nDelayMillis, EventChannel channel = EVENT_CHANNEL_GAMEPLAY);
+
+               9. TimerHandle ScheduleRepeating(BaseEventData& pEvent, unsigned long nIntervalMillis, EventChannel channel = EVENT_CHANNEL_GAMEPLAY);
+
+              10. bool CancelScheduled(TimerHandle handle);
+
+              11. void EnableStats(bool bEnable);
+
+              12. const EventTypeStats* GetStats(const EventType& type) const;
+
+              13. void DumpStats(std::ostream& out) const;
+
+              14. void SetStatsDump(const std::string& path, unsigned long nIntervalMillis);
+
+              15. bool StartRecording(const std::string& path);
+
+              16. bool StartReplay(const std::string& path);
+
+              17. void RecordEvent(BaseEventData& pEvent, EventChannel channel);
+
+              18. void SetInputDispatch(const InputDispatchDelegate& dispatch);
+
+              18. template <typename E>
+                  bool Bridge(void);
+
+              19. template <typename E>
+                  bool Unbridge(void);
                
-               6. template <void(*Function)(BaseEventData*)>
-	              bool Bind(const EventType& type);
+              20. template <void(*Function)(BaseEventData*)>
+	              bool Bind(const EventType& type, EventTarget target = EVENT_TARGET_NONE);
                    
-               7. template <class C, void(C::*Function)(BaseEventData*)>
-	              bool Bind(C* instance, const EventType& type);
+              21. template <class C, void(C::*Function)(BaseEventData*)>
+	              bool Bind(C* instance, const EventType& type, EventTarget target = EVENT_TARGET_NONE);
 
-               8. template <void(*Function)(BaseEventData*)>
-	              bool Unbind(const EventType& type);
+              22. template <void(*Function)(BaseEventData*)>
+	              bool Unbind(const EventType& type, EventTarget target = EVENT_TARGET_NONE);
                   
-               9. template <class C, void(C::*Function)(BaseEventData*)>
-	              bool Unbind(C* instance, const EventType& type);
+              23. template <class C, void(C::*Function)(BaseEventData*)>
+	              bool Unbind(C* instance, const EventType& type, EventTarget target = EVENT_TARGET_NONE);
 
 ---------------------------------------------------------*/
 
@@ -44,86 +76,217 @@
 
 #pragma once
 #include "Leadwerks.h"
+#include "..\Utilities\Bus.hpp"
+#include "..\Utilities\Clock.hpp"
 #include "..\Utilities\Delegate.hpp"
 #include "..\Utilities\Event.hpp"
+#include "..\Utilities\EventRecorder.hpp"
+#include "..\Utilities\EventStats.hpp"
 #include "..\Utilities\Macros.hpp"
+#include "..\Utilities\TimerWheel.hpp"
 
+#include <atomic>
 #include <list>
 #include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
 
-/* Define the number of queues the event manager uses internally to process events.*/
+/* Define the number of queues each event channel uses internally to process events.*/
 #define	NUM_QUEUES 2
 
-typedef Delegate<BaseEventData*>						EventListenerDelegate;																		// Definition fora delegate, specifically used for events.
+/* Event channels, in order of processing priority. Every channel is given its own time
+   - budget each frame, so a backlog in a lower channel never delays a higher one. */
+enum EventChannel {
+	EVENT_CHANNEL_INPUT = 0,
+	EVENT_CHANNEL_GAMEPLAY,
+	EVENT_CHANNEL_BACKGROUND,
+
+	NUM_EVENT_CHANNELS
+};
+
+typedef Delegate<void(void)>							InputDispatchDelegate;																		// Definition for a delegate delivering input queued outside the event-manager.
+typedef Delegate<void(BaseEventData*)>					EventListenerDelegate;																		// Definition fora delegate, specifically used for events.
+typedef EventStats<EventListenerDelegate::Stub>			EventTypeStats;																				// Definition for the instrumentation recorded per event-type.
 
 class EventManager {
 
 	CLASS_TYPE(EventManager);
 
 	enum eConstants { KINFINITE = 0xffffffff };
-	typedef std::list<EventListenerDelegate>			EventListenerList;																			// Definition for a list of event-listener delegates.
-	typedef std::map<EventType, EventListenerList>		EventMap;																					// Definition for event-listeners, seperated by event-type.
+	typedef MulticastDelegate<void(BaseEventData*)>	EventListenerList;																			// Definition for a list of event-listener delegates.
+	typedef std::unordered_map<EventTarget,
+							   EventListenerList>		TargetMap;																					// Definition for event-listeners, seperated by target.
+
+	struct EventListeners {
+		EventListenerList								broadcast;																					// Listeners of every event of the type, targeted or not.
+		TargetMap										targeted;																					// Listeners of the events routed to a single target.
+	};
+
+	typedef std::unordered_map<EventType,
+							   EventListeners>			EventMap;																					// Definition for event-listeners, seperated by event-type.
 	typedef std::list<BaseEventData*>					EventQueue;																					// Definition for a queue of event-data.
 
 public:
-														EventManager();																				// Event manager constructor.
+	typedef std::map<EventType, EventTypeStats>			EventStatsMap;																				// Definition for instrumentation, seperated by event-type.
+
+private:
+
+	struct EventChannelData {
+		EventChannel									id;																							// The channel this data belongs to.
+		EventQueue										queues[NUM_QUEUES];																			// Double-buffered event queues for this channel.
+		int												nActiveQueue;																				// Indicates which queue is currently accepting new events.
+		unsigned long									nBudgetMicros;																				// The current per-frame processing budget.
+		unsigned long									nMinBudgetMicros;																			// The budget never adapts below this value.
+		unsigned long									nMaxBudgetMicros;																			// The budget never adapts above this value.
+		unsigned long									nUsedMicros;																				// Time spent processing this channel last update.
+	};
+
+	struct ScheduledEvent {
+		BaseEventData*									pEvent;																						// The event to queue once the timer expires.
+		EventChannel									channel;																					// The channel the event is queued on.
+
+		ScheduledEvent(BaseEventData* _pEvent = nullptr, EventChannel _channel = EVENT_CHANNEL_GAMEPLAY)
+			: pEvent(_pEvent), channel(_channel) { }
+	};
+
+public:
+														EventManager(Clock* pClock = nullptr);														// Event manager constructor. Scheduled events are driven by
+																																					// - the given clock, or by the Leadwerks timer if none is given.
 														~EventManager();																			// Event manager destructor.
 
-	bool												Update(unsigned long nMaxMillis = 20);															// Processes any events within the event-manager's event queue
-																																					// for the given amount of time, per frame.
+	bool												Update(void);																				// Processes the queued events of every channel, in priority
+																																					// - order, each within its own time budget.
+	void												AdaptBudgets(long nHeadroomMicros);															// Grows or shrinks each channel's budget based on the measured
+																																					// - headroom of the last frame.
 	void												Render();																					// Performs any 3d-rendering for the event manager.
 	void												Draw();																						// Performs any 2d-rendering for the event manager.
 
-	bool												AddListener(const EventListenerDelegate& eventDelegate, const EventType& type);				// Adds the given delegate to the event-listener list of the
-																																					// - given event-type.
-	bool												RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type);			// Removes the given delegate from the event-listener list
-																																					// - of the given event-type.
+	bool												AddListener(const EventListenerDelegate& eventDelegate, const EventType& type,				// Adds the given delegate to the event-listener list of the
+																	EventTarget target = EVENT_TARGET_NONE);								// - given event-type, or only of the given target.
+	bool												RemoveListener(const EventListenerDelegate& eventDelegate, const EventType& type,			// Removes the given delegate from the event-listener list
+																	   EventTarget target = EVENT_TARGET_NONE);								// - of the given event-type, or of the given target.
 
-	bool												TriggerEvent(BaseEventData& pEvent);														// Immediataly triggers the given event, calling all currently
-																																					// - registered listeners to the event.
-	bool												QueueEvent(BaseEventData& pEvent);															// Queues the given event to processed during the event-
-																																					// - manager's processing queue.
+	bool												TriggerEvent(BaseEventData& pEvent,															// Immediataly triggers the given event, calling all currently
+																	 EventChannel channel = EVENT_CHANNEL_GAMEPLAY);										// - registered listeners to the event.
+	bool												QueueEvent(BaseEventData& pEvent,															// Queues the given event to processed during the event-
+																   EventChannel channel = EVENT_CHANNEL_GAMEPLAY);										// - manager's processing queue of the given channel.
 	bool												AbortEvent(const EventType& type, bool bAll = false);										// Aborts the execution of the given event. If bAll is true,
 																																					// - all events of the given type are removed from processing.	
 
+	void												SetBudget(EventChannel channel, unsigned long nMinMicros, unsigned long nMaxMicros);		// Sets the range the given channel's budget may adapt within.
+	unsigned long										Budget(EventChannel channel) const;															// Gets the current per-frame budget of the given channel.
+	size_t												Backlog(EventChannel channel) const;														// Gets the number of events waiting in the given channel.
+
+	TimerHandle											ScheduleEvent(BaseEventData& pEvent, unsigned long nDelayMillis,							// Queues the given event once the given delay has passed.
+																	  EventChannel channel = EVENT_CHANNEL_GAMEPLAY);
+	TimerHandle											ScheduleRepeating(BaseEventData& pEvent, unsigned long nIntervalMillis,					// Queues the given event every interval until cancelled.
+																		  EventChannel channel = EVENT_CHANNEL_GAMEPLAY);
+	bool												CancelScheduled(TimerHandle handle);														// Cancels a scheduled event before it is next queued.
+	size_t												ScheduledCount(void) const;																	// Gets the number of pending scheduled events.
+
+	void												EnableStats(bool bEnable);																	// Turns recording of dispatch instrumentation on or off; off by default.
+	const EventTypeStats*								GetStats(const EventType& type) const;														// Gets the instrumentation of the given event-type, if any.
+	const EventStatsMap&								GetAllStats(void) const;																	// Gets the instrumentation of every event-type.
+	void												ResetStats(void);																			// Clears all recorded instrumentation.
+	void												DumpStats(std::ostream& out) const;															// Writes a readable summary of the instrumentation.
+	void												SetStatsDump(const std::string& path, unsigned long nIntervalMillis);						// Appends a summary to the given file every interval. An
+																																					// - interval of zero disables the periodic dump.
+
+	bool												StartRecording(const std::string& path);													// Writes every dispatched event, with its frame, to the given log.
+	void												StopRecording(void);																		// Closes the current recording.
+	bool												IsRecording(void) const;																	// Indicates whether dispatched events are being recorded.
+
+	bool												StartReplay(const std::string& path);														// Feeds the input-channel events of the given log back in, frame
+																																					// - by frame, in place of live input.
+	void												StopReplay(void);																			// Stops the current replay.
+	bool												IsReplaying(void) const;																	// Indicates whether input is being replayed from a log.
+	void												RecordEvent(BaseEventData& pEvent, EventChannel channel);									// Writes an event dispatched outside the event-manager, such as
+																																					// - one published on a Bus, to the current recording.
+	void												SetInputDispatch(const InputDispatchDelegate& dispatch);									// Sets what delivers the input queued on a Bus, each update, where the
+																																					// - input channel is processed.
+
+	uint32_t											Frame(void) const;																			// Gets the number of updates processed so far.
+	uint64_t											DispatchCount(void) const;																	// Gets the number of events handed to listeners so far,
+																																					// - queued or triggered.
+
 	template <void(*Function)(BaseEventData*)>
-	bool Bind(const EventType& type) {
+	bool Bind(const EventType& type, EventTarget target = EVENT_TARGET_NONE) {
 		EventListenerDelegate eventDelegate;
 		eventDelegate.Bind<Function>();
 
-		return AddListener(eventDelegate, type);
+		return AddListener(eventDelegate, type, target);
 	}
 	
 	template <class C, void(C::*Function)(BaseEventData*)>
-	bool Bind(C* instance, const EventType& type) {
+	bool Bind(C* instance, const EventType& type, EventTarget target = EVENT_TARGET_NONE) {
 		EventListenerDelegate eventDelegate;
 		eventDelegate.Bind<C, Function>(instance);
 
-		return AddListener(eventDelegate, type);
+		return AddListener(eventDelegate, type, target);
 	}
 
 	template <void(*Function)(BaseEventData*)>
-	bool Unbind(const EventType& type) {
+	bool Unbind(const EventType& type, EventTarget target = EVENT_TARGET_NONE) {
 		EventListenerDelegate eventDelegate;
 		eventDelegate.Bind<Function>();
 
-		return RemoveListener(eventDelegate, type);
+		return RemoveListener(eventDelegate, type, target);
 	}
 
 	template <class C, void(C::*Function)(BaseEventData*)>
-	bool Unbind(C* instance, const EventType& type) {
+	bool Unbind(C* instance, const EventType& type, EventTarget target = EVENT_TARGET_NONE) {
 		EventListenerDelegate eventDelegate;
 		eventDelegate.Bind<C, Function>(instance);
 
-		return RemoveListener(eventDelegate, type);
-	}	
+		return RemoveListener(eventDelegate, type, target);
+	}
+
+	/* Forwards dynamically dispatched events of type E, such as replayed ones, to Bus<E>. */
+	template <typename E>
+	bool Bridge(void) {
+		return Bind<&EventManager::BridgeStub<E>>(E::ClassId());
+	}
+
+	template <typename E>
+	bool Unbridge(void) {
+		return Unbind<&EventManager::BridgeStub<E>>(E::ClassId());
+	}
 
 protected:
 
+	template <typename E>
+	static void BridgeStub(BaseEventData* pEvent) {
+		Bus<E>::Publish(*static_cast<E*>(pEvent));
+	}
+
+
+	bool												ProcessChannel(EventChannelData& channel, unsigned long nBudgetMicros);					// Processes a single channel's queue within the given budget.
+	bool												Dispatch(BaseEventData* pEvent, EventChannel channel, bool bQueued);						// Calls every listener registered to the given event's type
+																																					// - and, if it is targeted, to its target.
+	void												Invoke(EventListenerList& listeners, BaseEventData* pEvent, EventTypeStats* pStats);		// Calls each of the given listeners, timing them into pStats if given.
+	void												DropEmptyTarget(EventListeners& listeners, EventTarget target);							// Erases the target's bucket, if its last listener has gone.
+	void												ReplayFrame(void);																			// Triggers the recorded input events of the current frame.
+
 private:	
 	EventMap											m_eventListeners;																			// Contains all event-listeners, seperated by event type.
-	EventQueue											m_queues[NUM_QUEUES];																		// Contains all events needing to be processed.
-	int													m_nActiveQueue;																				// Indicates which event-processing queue is currently being used.	
+	EventChannelData									m_channels[NUM_EVENT_CHANNELS];																// Contains all events needing to be processed, by channel.
+
+	Clock*												m_pClock;																					// The time source driving scheduled events.
+	bool												m_bOwnsClock;																				// Indicates whether the clock was created by the event-manager.
+	TimerWheel<ScheduledEvent>							m_timers;																					// Contains all scheduled events, keyed by expiry time.
+
+	bool												m_bStatsEnabled;																			// Indicates whether dispatch instrumentation is recorded.
+	EventStatsMap										m_stats;																					// Contains all dispatch instrumentation, by event-type.
+	std::string											m_statsDumpPath;																			// The file periodic summaries are appended to.
+	unsigned long										m_nStatsDumpInterval;																		// The time between periodic summaries, in milliseconds.
+	uint64_t											m_nNextStatsDump;																			// The clock time of the next periodic summary.
+
+	uint32_t											m_nFrame;																					// The number of updates processed so far.
+	std::atomic<uint64_t>								m_nDispatched;																				// The number of events handed to listeners so far; read from the render thread.
+	EventRecorder										m_recorder;																					// Writes dispatched events while recording.
+	EventPlayer											m_player;																					// Reads recorded events back while replaying.
+	InputDispatchDelegate								m_inputDispatch;																			// Delivers the input queued on a Bus, ahead of the input channel.
 
 }; // end class EventManager.
 
@@ -3,71 +3,36 @@
 #include "InputManager.hpp"
 #include "..\Utilities\Event.hpp"
 #include "EventManager.hpp"
-#include "..\Utilities\ParameterMap.hpp"
 
-#include <cassert>
-
-float InputManager::PosX() {
-	return this->GetMousePosition().x;
-}
-
-float InputManager::PosY() {
-	return this->GetMousePosition().y;
-}
-
-float InputManager::OldPosX() {
-	auto val = this->GetFloat("oldMouseX");
-	if (val != this->GetFloatMap().end()) { return val->second; }
-	else { return this->GetMousePosition().x; }
-}
-
-float InputManager::OldPosY() {
-	auto val = this->GetFloat("oldMouseY");
-	if (val != this->GetFloatMap().end()) { return val->second; }
-	else { return this->GetMousePosition().y; }
-}
-
-float InputManager::DeltaX() {
-	auto val = this->GetFloat("deltaX");
-	if (val != this->GetFloatMap().end()) { return val->second; }
-	else { return 0.0f; }
-}
-
-float InputManager::DeltaY() {
-	auto val = this->GetFloat("deltaY");
-	if (val != this->GetFloatMap().end()) { return val->second; }
-	else { return 0.0f; }
-}
-
-float InputManager::CenterX() {
-	auto val = this->GetFloat("centerX");
-	if (val != this->GetFloatMap().end()) { return val->second; }
-	else { return this->GetWindowCenter().x; }
-}
+#include "..\Utilities\LatencyMonitor.hpp"
+#include "..\Utilities\Timer.hpp"
 
-float InputManager::CenterY() {
-	auto val = this->GetFloat("centerY");
-	if (val != this->GetFloatMap().end()) { return val->second; }
-	else { return this->GetWindowCenter().y; }
-}
+#include <cassert>
 
 void InputManager::ToggleMouseCenter() {
-	this->m_bCenterMouse = !this->m_bCenterMouse;
+	this->m_bCenterMouse.store(!this->m_bCenterMouse.load());
 }
 
 void InputManager::CenterMouse(void) { 
-	this->m_pWindow->SetMousePosition(CenterX(), CenterY()); 
-}
+	if (this->m_pWindow == nullptr) { return; }
 
-void InputManager::UpdateMousePosition(void) { 
-	this->m_pWindow->SetMousePosition(PosX(), PosY());
+	/* The next sample measures from where the pointer was put. */
+	Leadwerks::Vec3 vCenter = GetWindowCenter();
+	this->m_pWindow->SetMousePosition(vCenter.x, vCenter.y); 
+
+	m_fSampledX = vCenter.x;
+	m_fSampledY = vCenter.y;
 }
 
 Leadwerks::Vec3 InputManager::GetMousePosition() {
+	if (this->m_pWindow == nullptr) { return Leadwerks::Vec3(m_mouse.fPosX, m_mouse.fPosY, 0.0f); }
+
 	return this->m_pWindow->GetMousePosition();
 }
 
 Leadwerks::Vec3 InputManager::GetWindowCenter() {
+	if (this->m_pWindow == nullptr) { return Leadwerks::Vec3(0.0f, 0.0f, 0.0f); }
+
 	return Leadwerks::Vec3(
 		this->m_pWindow->GetWidth() * 0.5f,		// Half-width
 		this->m_pWindow->GetHeight() * 0.5f,	// Half-height
@@ -87,18 +52,25 @@ void InputManager::SetContext(Leadwerks::Context* pContext) {
 }
 
 InputManager::InputManager(void)
-	: m_pWindow(nullptr), m_pContext(nullptr), m_bCenterMouse(false), m_pEventManager(nullptr)
+	: m_pWindow(nullptr), m_pContext(nullptr), m_bCenterMouse(false), m_bMouseMovedThisFrame(false), m_fPendingDeltaX(0.0f), m_fPendingDeltaY(0.0f), m_pEventManager(nullptr),
+	  m_nPreviousMouseButtons(0), m_nPressedMouseButtons(0), m_mouse(), m_published(),
+	  m_nSampledButtons(0), m_fSampledX(0.0f), m_fSampledY(0.0f),
+	  m_bSampling(false), m_nSampleHz(0), m_nNextSampleMicros(0), m_nDroppedTransitions(0)
 {
 
 }
 
 InputManager::InputManager(Leadwerks::Window* pWindow, Leadwerks::Context* pContext, EventManager* pEventManager) 
-	: m_pWindow(pWindow), m_pContext(pContext), m_bCenterMouse(false), m_pEventManager(pEventManager) {
+	: m_pWindow(pWindow), m_pContext(pContext), m_bCenterMouse(false), m_bMouseMovedThisFrame(false), m_fPendingDeltaX(0.0f), m_fPendingDeltaY(0.0f), m_pEventManager(pEventManager),
+	  m_nPreviousMouseButtons(0), m_nPressedMouseButtons(0), m_mouse(), m_published(),
+	  m_nSampledButtons(0), m_fSampledX(0.0f), m_fSampledY(0.0f),
+	  m_bSampling(false), m_nSampleHz(0), m_nNextSampleMicros(0), m_nDroppedTransitions(0) {
 
 	Initialize(pWindow, pContext, pEventManager);
 }
 
 InputManager::~InputManager() {
+	StopSampling();
 	UnRegisterInputEvents();
 
 	this->m_pWindow = nullptr;
@@ -107,185 +79,361 @@ InputManager::~InputManager() {
 
 void InputManager::Initialize(Leadwerks::Window* pWindow, Leadwerks::Context* pContext, EventManager* pEventManager)
 {
-	assert(this->m_pWindow != nullptr);
-	assert(this->m_pContext != nullptr);
+	/* Without a window, e.g. when headless, there is nothing to poll and input
+	 * - only arrives through the EventManager, as when replaying. */
+	assert((this->m_pWindow == nullptr) == (this->m_pContext == nullptr));
 
 	RegisterInputEvents();
 
-	Set("centerX", this->m_pWindow->GetWidth() * 0.5f);
-	Set("centerY", this->m_pWindow->GetHeight() * 0.5f);
-	this->m_pWindow->SetMousePosition(CenterX(), CenterY());
+	Leadwerks::Vec3 vCenter = GetWindowCenter();
+	if (this->m_pWindow != nullptr) { this->m_pWindow->SetMousePosition(vCenter.x, vCenter.y); }
+
+	/* Seed the snapshot, so readers never see an unset one. */
+	Leadwerks::Vec3 vMousePosition = this->GetMousePosition();
+
+	m_mouse.fCenterX = vCenter.x;
+	m_mouse.fCenterY = vCenter.y;
+	m_mouse.fPosX = m_mouse.fOldPosX = vMousePosition.x;
+	m_mouse.fPosY = m_mouse.fOldPosY = vMousePosition.y;
+	m_mouse.fDeltaX = m_mouse.fDeltaY = 0.0f;
 
-	/* Register input-properties */
-	Set("currMouseX", this->GetMousePosition().x)->
-		Set("currMouseY", this->GetMousePosition().y)->
-		Set("oldMouseX", this->GetMousePosition().x)->
-		Set("oldMouseY", this->GetMousePosition().y)->
-		Set("deltaX", 0.0f)->
-		Set("deltaY", 0.0f);
+	PublishMouseState();
 
+	m_fSampledX = vMousePosition.x;
+	m_fSampledY = vMousePosition.y;
+
+	this->Sample();
 	this->Update(1.0f);
 }
 
 void InputManager::Update(float deltaTime) {
-	GenerateInputEvents();
+	/* Input only arrives as the transitions Sample queued; the window itself
+	 * - is never read here, as this may be the simulation thread. */
+	DrainTransitions();
+
+	/* While replaying, keys and mouse movement arrive through the EventManager
+	 * - instead of being sampled from the window. */
+	if (m_pEventManager->IsReplaying() || m_pWindow == nullptr) {
+		m_transitions.clear();
+
+		if (m_bMouseMovedThisFrame) {
+			m_fPendingDeltaX += m_mouse.fDeltaX;
+			m_fPendingDeltaY += m_mouse.fDeltaY;
+		}
 
-	this->Set("currMouseX", this->PosX());
-	this->Set("currMouseY", this->PosY());
+		m_mouse.fDeltaX = 0.0f;
+		m_mouse.fDeltaY = 0.0f;
 
-	float deltaX = this->PosX() - this->OldPosX();
-	float deltaY = this->PosY() - this->OldPosY();
+		m_bMouseMovedThisFrame = false;
+		PublishMouseState();
+		return;
+	}
 
-	this->Set("deltaX", deltaX);
-	this->Set("deltaY", deltaY);
-	if (this->DeltaX() == 0.0f && this->DeltaY() == 0.0f) { return; }
+	/* Sampled input is timed from when it was sampled, rather than from this update. */
+	if (!m_transitions.empty()) { gLatencyMonitor.MarkInput(m_transitions.front().nMicros); }
+
+	/* Replay this frame's transitions over last frame's state. */
+	BitSet256 currentKeys = m_previousKeys;
+	uint32_t nCurrentButtons = m_nPreviousMouseButtons;
+
+	m_mouse.fDeltaX = 0.0f;
+	m_mouse.fDeltaY = 0.0f;
+
+	for (auto& transition : m_transitions) {
+		switch (transition.kind) {
+		case InputTransition::KEY:
+			if (transition.bDown) { currentKeys.Set(transition.nCode); }
+			else { currentKeys.Reset(transition.nCode); }
+			break;
+
+		case InputTransition::MOUSE_BUTTON:
+			if (transition.bDown) { nCurrentButtons |= (1u << transition.nCode); }
+			else { nCurrentButtons &= ~(1u << transition.nCode); }
+			break;
+
+		case InputTransition::MOUSE_MOVE:
+			m_mouse.fPosX = transition.fX;
+			m_mouse.fPosY = transition.fY;
+			m_mouse.fDeltaX += transition.fDeltaX;
+			m_mouse.fDeltaY += transition.fDeltaY;
+			break;
+		}
+	}
 
-	if (this->m_bCenterMouse) { this->CenterMouse(); }
-	else { this->UpdateMousePosition(); }
+	/* Movement is measured from where the pointer was left, which is the
+	 * - center when re-centering. */
+	m_mouse.fOldPosX = m_mouse.fPosX - m_mouse.fDeltaX;
+	m_mouse.fOldPosY = m_mouse.fPosY - m_mouse.fDeltaY;
 
-	this->Set("oldMouseX", PosX());
-	this->Set("oldMouseY", PosY());
-}
+	GenerateInputEvents(currentKeys, nCurrentButtons);
 
-void InputManager::CheckMouseInput(int button) {
-	Leadwerks::Vec3 vMousePosition = GetMousePosition();	
-
-	/* Snag the current and previous mouse-button's state. */
-	bool bCurrent = m_currentMouseState[button] = m_pWindow->mousedownstate[button];
-	bool bCurrentPressedState = m_currentMousePressedState[button];
-	bool bPrevious = m_previousMouseState[button];	
-	
-	/* Was the button hit? */
-	if (bCurrent && !bPrevious) {
-		/* Create LeftMouseButton Hit Event. */
-		auto buttonHit = (gEventFactory.Create("Event_MouseHit"));
-
-		/* Set the required values for the event. */
-		buttonHit->Set("vMousePosition", vMousePosition);
-		buttonHit->Set("nMouseButton", button);
-
-		/* Queue the event for execution. */
-		m_pEventManager->QueueEvent(*buttonHit);
+	if (m_mouse.fDeltaX != 0.0f || m_mouse.fDeltaY != 0.0f) {
+		/* Publish a mouse-move so the movement is seen by the EventManager's recorder. */
+		m_mouseMoveEvent.Set("vMousePosition", Leadwerks::Vec3(m_mouse.fPosX, m_mouse.fPosY, 0.0f));
+		m_mouseMoveEvent.Set("fDeltaX", m_mouse.fDeltaX);
+		m_mouseMoveEvent.Set("fDeltaY", m_mouse.fDeltaY);
+		Publish(m_mouseMoveEvent);
 	}
-	/* Is the button pressed? */
-	else if (!bCurrentPressedState) {
-		if (bCurrent && bPrevious) {
-			/* Create LeftMouseButton Pressed Event. */
-			auto buttonPressed = (gEventFactory.Create("Event_MouseDown"));
 
-			/* Set the required values for the event. */
-			buttonPressed->Set("vMousePosition", vMousePosition);
-			buttonPressed->Set("nMouseButton", button);
+	/* The movement is held until a step consumes it, rather than handed to
+	 * - however many steps this frame runs. */
+	m_fPendingDeltaX += m_mouse.fDeltaX;
+	m_fPendingDeltaY += m_mouse.fDeltaY;
 
-			/* Queue the event for execution. */
-			m_pEventManager->QueueEvent(*buttonPressed);
+	m_mouse.fDeltaX = 0.0f;
+	m_mouse.fDeltaY = 0.0f;
 
-			m_currentMousePressedState[button] = true;
-		}
-	}
-	/* Was the button released? */
-	else if (!bCurrent && bPrevious) {
-		/* Create LeftMouseButton Released Event. */
-		auto buttonUp = (gEventFactory.Create("Event_MouseUp"));
+	PublishMouseState();
+}
 
-		/* Set the required values for the event. */
-		buttonUp->Set("vMousePosition", vMousePosition);
-		buttonUp->Set("nMouseButton", button);
+void InputManager::BeginStep(void) {
+	/* The first step gets all the movement since the last step; any others
+	 * - this frame get none, and a frame with no steps keeps it for the next. */
+	m_mouse.fDeltaX = m_fPendingDeltaX;
+	m_mouse.fDeltaY = m_fPendingDeltaY;
 
-		/* Queue the event for execution. */
-		m_pEventManager->QueueEvent(*buttonUp);
+	m_fPendingDeltaX = 0.0f;
+	m_fPendingDeltaY = 0.0f;
 
-		m_currentMousePressedState[button] = false;
-	}
+	PublishMouseState();
+}
+
+void InputManager::PublishMouseState(void) {
+	std::lock_guard<std::mutex> lock(m_publishMutex);
+	m_published = m_mouse;
+}
 
-	/* Store the current down state for the left mouse button so we 
-	 * - can check it next frame. */
-	m_previousMouseState[button] = bCurrent;	
+MouseState InputManager::Mouse() const {
+	std::lock_guard<std::mutex> lock(m_publishMutex);
+	return m_published;
 }
 
-void InputManager::CheckKeyboardInput(int key) {
-	/* Snag the current and previous mouse-button's state. */
-	bool bCurrent = m_currentKeyboardState[key] = m_pWindow->keydownstate[key];
-	bool bCurrentPressedState = m_currentKeyboardPressedState[key];
-	bool bPrevious = m_previousKeyboardState[key];
+void InputManager::Sample() {
+	if (m_pWindow == nullptr) { return; }
 
-	/* Was the key hit? */
-	if (bCurrent && !bPrevious) {
-		/* Create key-hit Event. */
-		auto keyHit = (gEventFactory.Create("Event_KeyHit"));
+	uint64_t nMicros = Timer::Micros();
+	if (IsSampling()) { m_nNextSampleMicros = nMicros + 1000000 / m_nSampleHz; }
 
-		/* Set the required values for the event. */		
-		keyHit->Set("nKey", key);
+	BitSet256 keys = BitSet256::FromBools(m_pWindow->keydownstate);
+	(keys ^ m_sampledKeys).ForEach([&](unsigned key) {
+		PushTransition({ nMicros, InputTransition::KEY, (uint8_t)(key), keys.Test(key), 0.0f, 0.0f, 0.0f, 0.0f });
+	});
+	m_sampledKeys = keys;
 
-		/* Queue the event for execution. */
-		m_pEventManager->QueueEvent(*keyHit);
+	/* Mouse only has 6 buttons, so the same diff fits in a single word. */
+	uint32_t nButtons = 0;
+	for (unsigned button = 0; button < 6; button++) {
+		if (m_pWindow->mousedownstate[button]) { nButtons |= (1u << button); }
 	}
-	/* Is the key pressed? */
-	else if (!bCurrentPressedState) {
-		if (bCurrent && bPrevious) {
-			/* Create key-pressed Event. */
-			auto keyPressed = (gEventFactory.Create("Event_KeyDown"));
 
-			/* Set the required values for the event. */			
-			keyPressed->Set("nKey", key);
+	for (uint32_t nChanged = nButtons ^ m_nSampledButtons; nChanged != 0; nChanged &= nChanged - 1) {
+		unsigned button = BitSet256::CountTrailingZeros(nChanged);
+		PushTransition({ nMicros, InputTransition::MOUSE_BUTTON, (uint8_t)(button), (nButtons & (1u << button)) != 0, 0.0f, 0.0f, 0.0f, 0.0f });
+	}
+	m_nSampledButtons = nButtons;
 
-			/* Queue the event for execution. */
-			m_pEventManager->QueueEvent(*keyPressed);
+	/* Moving the pointer back to the center happens here, on the same thread
+	 * - as the sampling, so it is never mistaken for input. */
+	Leadwerks::Vec3 vPosition = m_pWindow->GetMousePosition();
+	if (vPosition.x == m_fSampledX && vPosition.y == m_fSampledY) { return; }
 
-			m_currentKeyboardPressedState[key] = true;
-		}
+	PushTransition({ nMicros, InputTransition::MOUSE_MOVE, 0, false, vPosition.x, vPosition.y, vPosition.x - m_fSampledX, vPosition.y - m_fSampledY });
+
+	if (m_bCenterMouse.load(std::memory_order_relaxed)) { CenterMouse(); }
+	else {
+		m_fSampledX = vPosition.x;
+		m_fSampledY = vPosition.y;
 	}
-	/* Was the key released? */
-	else if (!bCurrent && bPrevious) {
-		/* Create key-up Event. */
-		auto keyUp = (gEventFactory.Create("Event_KeyUp"));
+}
 
-		/* Set the required values for the event. */		
-		keyUp->Set("nKey", key);
+void InputManager::SampleIdle() {
+	if (!IsSampling() || Timer::Micros() < m_nNextSampleMicros) { return; }
 
-		/* Queue the event for execution. */
-		m_pEventManager->QueueEvent(*keyUp);
+	Sample();
+}
 
-		m_currentKeyboardPressedState[key] = false;
-	}
+bool InputManager::StartSampling(unsigned nHz) {
+	if (nHz == 0 || IsSampling() || m_pWindow == nullptr) { return false; }
+
+	m_nSampleHz = nHz;
+	m_nNextSampleMicros = 0;
+	m_bSampling.store(true, std::memory_order_release);
+
+	return true;
+}
+
+void InputManager::StopSampling() {
+	m_bSampling.store(false, std::memory_order_release);
+}
+
+void InputManager::PushTransition(const InputTransition& transition) {
+	if (!m_sampledTransitions.TryPush(transition)) { m_nDroppedTransitions.fetch_add(1, std::memory_order_relaxed); }
+}
+
+void InputManager::DrainTransitions(void) {
+	m_transitions.clear();
+
+	InputTransition transition;
+	while (m_sampledTransitions.TryPop(transition)) { m_transitions.push_back(transition); }
+}
+
+void InputManager::OnMouseMove(Event_MouseMove& event) {
+	/* Live movement is already applied in Update; only replayed movement needs applying. */
+	if (!m_pEventManager->IsReplaying()) { return; }
+
+	Leadwerks::Vec3 vMousePosition = event.MousePosition();
+
+	m_mouse.fPosX = m_mouse.fOldPosX = vMousePosition.x;
+	m_mouse.fPosY = m_mouse.fOldPosY = vMousePosition.y;
+	m_mouse.fDeltaX = event.DeltaX();
+	m_mouse.fDeltaY = event.DeltaY();
+
+	m_bMouseMovedThisFrame = true;
+}
+
+void InputManager::OnKeyDown(Event_KeyDown& event) {
+	/* Live keys are already tracked in GenerateInputEvents; only replayed keys need applying. */
+	if (!m_pEventManager->IsReplaying() || event.Key() < 0) { return; }
+
+	m_pressedKeys.Set(event.Key() & 0xff);
+}
 
-	/* Store the current down state for the left mouse button so we
-	* - can check it next frame. */
-	m_previousKeyboardState[key] = bCurrent;
+void InputManager::OnKeyUp(Event_KeyUp& event) {
+	if (!m_pEventManager->IsReplaying() || event.Key() < 0) { return; }
+
+	m_pressedKeys.Reset(event.Key() & 0xff);
 }
 
 void InputManager::RegisterInputEvents(void) {
 	REGISTER_EVENT((new FactoryMaker<Event_MouseHit, BaseEventData>));
 	REGISTER_EVENT((new FactoryMaker<Event_MouseDown, BaseEventData>));
 	REGISTER_EVENT((new FactoryMaker<Event_MouseUp, BaseEventData>));
+	REGISTER_EVENT((new FactoryMaker<Event_MouseMove, BaseEventData>));
 
 	REGISTER_EVENT((new FactoryMaker<Event_KeyHit, BaseEventData>));
 	REGISTER_EVENT((new FactoryMaker<Event_KeyDown, BaseEventData>));
 	REGISTER_EVENT((new FactoryMaker<Event_KeyUp, BaseEventData>));
+
+	/* Replayed input is triggered through the EventManager; bridge it onto the buses. */
+	m_pEventManager->Bridge<Event_MouseHit>();
+	m_pEventManager->Bridge<Event_MouseDown>();
+	m_pEventManager->Bridge<Event_MouseUp>();
+	m_pEventManager->Bridge<Event_MouseMove>();
+
+	m_pEventManager->Bridge<Event_KeyHit>();
+	m_pEventManager->Bridge<Event_KeyDown>();
+	m_pEventManager->Bridge<Event_KeyUp>();
+
+	/* Queued input is delivered by the EventManager, where the input channel is processed. */
+	InputDispatchDelegate dispatch;
+	dispatch.Bind<InputManager, &InputManager::DispatchEvents>(this);
+	m_pEventManager->SetInputDispatch(dispatch);
+
+	Bus<Event_MouseMove>::Subscribe<InputManager, &InputManager::OnMouseMove>(this);
+	Bus<Event_KeyDown>::Subscribe<InputManager, &InputManager::OnKeyDown>(this);
+	Bus<Event_KeyUp>::Subscribe<InputManager, &InputManager::OnKeyUp>(this);
 }
 
 void InputManager::UnRegisterInputEvents(void) {	
+	m_pEventManager->SetInputDispatch(InputDispatchDelegate());
+
+	Bus<Event_MouseMove>::Unsubscribe<InputManager, &InputManager::OnMouseMove>(this);
+	Bus<Event_KeyDown>::Unsubscribe<InputManager, &InputManager::OnKeyDown>(this);
+	Bus<Event_KeyUp>::Unsubscribe<InputManager, &InputManager::OnKeyUp>(this);
+
+	m_pEventManager->Unbridge<Event_MouseHit>();
+	m_pEventManager->Unbridge<Event_MouseDown>();
+	m_pEventManager->Unbridge<Event_MouseUp>();
+	m_pEventManager->Unbridge<Event_MouseMove>();
+
+	m_pEventManager->Unbridge<Event_KeyHit>();
+	m_pEventManager->Unbridge<Event_KeyDown>();
+	m_pEventManager->Unbridge<Event_KeyUp>();
+
 	gEventFactory.Unregister("Event_MouseHit");
 	gEventFactory.Unregister("Event_MouseDown");
 	gEventFactory.Unregister("Event_MouseUp");
+	gEventFactory.Unregister("Event_MouseMove");
 
 	gEventFactory.Unregister("Event_KeyHit");
 	gEventFactory.Unregister("Event_KeyDown");
 	gEventFactory.Unregister("Event_KeyUp");
 }
 
-void InputManager::GenerateInputEvents(void) {
-	unsigned index = 0;
-	while (index < 256) {
-		/* Keyboard has 256 keys so for each iteration, check
-		 * - the current input for the key. */
-		CheckKeyboardInput(index);
-
-		/* Mouse only has 6 buttons so rather than have a 
-		 * - seperate loop. just check button state
-		 * - where appropriate. */
-		if (index < 6) { CheckMouseInput(index); }
-
-		index += 1;
-	}	
-}
\ No newline at end of file
+void InputManager::GenerateInputEvents(const BitSet256& currentKeys, uint32_t nCurrentButtons) {
+	/* Diff this frame's key states against last frame's:
+	 * - hit:  down now, but not last frame.
+	 * - down: down now and last frame, and not yet reported as pressed.
+	 * - up:   released this frame, after being reported as pressed.
+	 * - Only the keys which changed are visited when queuing. */
+	BitSet256 hitKeys = currentKeys.AndNot(m_previousKeys);
+	BitSet256 downKeys = (currentKeys & m_previousKeys).AndNot(m_pressedKeys);
+	BitSet256 upKeys = m_previousKeys.AndNot(currentKeys) & m_pressedKeys;
+
+	m_pressedKeys = (m_pressedKeys | downKeys).AndNot(upKeys);
+	m_previousKeys = currentKeys;
+
+	/* The events are queued, as they were on the input channel, and published by the
+	 * - EventManager's next update; see DispatchEvents. */
+	hitKeys.ForEach([this](unsigned key) { m_queuedEvents.push_back({ QueuedInput::KEY_HIT, (uint8_t)(key), 0.0f, 0.0f }); });
+	downKeys.ForEach([this](unsigned key) { m_queuedEvents.push_back({ QueuedInput::KEY_DOWN, (uint8_t)(key), 0.0f, 0.0f }); });
+	upKeys.ForEach([this](unsigned key) { m_queuedEvents.push_back({ QueuedInput::KEY_UP, (uint8_t)(key), 0.0f, 0.0f }); });
+
+	/* Mouse only has 6 buttons, so the same diff fits in a single word. */
+	uint32_t nHitButtons = nCurrentButtons & ~m_nPreviousMouseButtons;
+	uint32_t nDownButtons = nCurrentButtons & m_nPreviousMouseButtons & ~m_nPressedMouseButtons;
+	uint32_t nUpButtons = ~nCurrentButtons & m_nPreviousMouseButtons & m_nPressedMouseButtons;
+
+	m_nPressedMouseButtons = (m_nPressedMouseButtons | nDownButtons) & ~nUpButtons;
+	m_nPreviousMouseButtons = nCurrentButtons;
+
+	for (; nHitButtons != 0; nHitButtons &= nHitButtons - 1) {
+		m_queuedEvents.push_back({ QueuedInput::MOUSE_HIT, (uint8_t)(BitSet256::CountTrailingZeros(nHitButtons)), m_mouse.fPosX, m_mouse.fPosY });
+	}
+
+	for (; nDownButtons != 0; nDownButtons &= nDownButtons - 1) {
+		m_queuedEvents.push_back({ QueuedInput::MOUSE_DOWN, (uint8_t)(BitSet256::CountTrailingZeros(nDownButtons)), m_mouse.fPosX, m_mouse.fPosY });
+	}
+
+	for (; nUpButtons != 0; nUpButtons &= nUpButtons - 1) {
+		m_queuedEvents.push_back({ QueuedInput::MOUSE_UP, (uint8_t)(BitSet256::CountTrailingZeros(nUpButtons)), m_mouse.fPosX, m_mouse.fPosY });
+	}
+}
+
+void InputManager::DispatchEvents(void) {
+	/* Each kind reuses its one event instance, so every event is published before the
+	 * - next is written into it. Listeners may queue more input; that waits a frame. */
+	std::vector<QueuedInput> queued;
+	queued.swap(m_queuedEvents);
+
+	for (auto& input : queued) {
+		Leadwerks::Vec3 vMousePosition(input.fX, input.fY, 0.0f);
+
+		switch (input.kind) {
+		case QueuedInput::KEY_HIT:		m_keyHitEvent.Set("nKey", (int)(input.nCode)); Publish(m_keyHitEvent); break;
+		case QueuedInput::KEY_DOWN:		m_keyDownEvent.Set("nKey", (int)(input.nCode)); Publish(m_keyDownEvent); break;
+		case QueuedInput::KEY_UP:		m_keyUpEvent.Set("nKey", (int)(input.nCode)); Publish(m_keyUpEvent); break;
+
+		case QueuedInput::MOUSE_HIT:
+			m_mouseHitEvent.Set("vMousePosition", vMousePosition);
+			m_mouseHitEvent.Set("nMouseButton", (int)(input.nCode));
+			Publish(m_mouseHitEvent);
+			break;
+
+		case QueuedInput::MOUSE_DOWN:
+			m_mouseDownEvent.Set("vMousePosition", vMousePosition);
+			m_mouseDownEvent.Set("nMouseButton", (int)(input.nCode));
+			Publish(m_mouseDownEvent);
+			break;
+
+		case QueuedInput::MOUSE_UP:
+			m_mouseUpEvent.Set("vMousePosition", vMousePosition);
+			m_mouseUpEvent.Set("nMouseButton", (int)(input.nCode));
+			Publish(m_mouseUpEvent);
+			break;
+		}
+	}
+
+	/* Keep the capacity, so queuing does not allocate once warmed up. */
+	if (m_queuedEvents.empty()) { m_queuedEvents.swap(queued); m_queuedEvents.clear(); }
+}
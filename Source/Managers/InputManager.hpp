@@ -23,11 +23,43 @@
 #pragma once
 #include "..\Common.hpp"
 #include "..\Utilities\Macros.hpp"
-#include "..\Utilities\ParameterMap.hpp"
-
-class EventManager;
-
-class InputManager : ParameterMap {
+#include "..\Utilities\BitSet256.hpp"
+#include "..\Utilities\Bus.hpp"
+#include "..\Utilities\Event.hpp"
+#include "..\Utilities\RingBuffer.hpp"
+#include "EventManager.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/* A snapshot of the mouse, published by each Update and each step. */
+struct MouseState {
+	float						fPosX;											// The x-position of the mouse pointer, this frame.
+	float						fPosY;											// The y-position of the mouse pointer, this frame.
+	float						fOldPosX;										// The x-position the movement was measured from.
+	float						fOldPosY;										// The y-position the movement was measured from.
+	float						fDeltaX;										// The change in x-position since the last step.
+	float						fDeltaY;										// The change in y-position since the last step.
+	float						fCenterX;										// The center x-position of the window.
+	float						fCenterY;										// The center y-position of the window.
+};
+
+/* A single change of input state, seen when the window was sampled. */
+struct InputTransition {
+	enum Kind : uint8_t { KEY, MOUSE_BUTTON, MOUSE_MOVE };
+
+	uint64_t					nMicros;										// When the change was sampled, as a Timer::Micros() timestamp.
+	Kind						kind;
+	uint8_t						nCode;											// The key or mouse button; unused for moves.
+	bool						bDown;											// Whether the key or button is now held; unused for moves.
+	float						fX;												// The mouse pointer's position, for moves.
+	float						fY;
+	float						fDeltaX;										// How far it moved since the last sample, for moves.
+	float						fDeltaY;
+};
+
+class InputManager {
 
 	CLASS_TYPE(InputManager);
 
@@ -43,52 +75,131 @@ public:
 
 	void						Update(float deltaTime);						// InputManager Update.
 
+	/* Called before each fixed step. Update only gathers the frame's mouse movement;
+	 * - this hands everything gathered since the last step to the one about to run. */
+	void						BeginStep(void);
+
 	void						SetWindow(Leadwerks::Window* pWindow);			// Sets the input-manager's window handle.
 	void						SetContext(Leadwerks::Context* pContext);		// Sets the input-manager's context handle.
 
-	float						PosX();											// Gets the current x-position of the mouse pointer.
-	float						PosY();											// Gets the current y-position of the mouse pointer.
-	float						OldPosX();										// Gets the x-position of the mouse pointer, last frame.
-	float						OldPosY();										// Gets the y-position of the mouse pointer, last frame.
+	/* A copy of the latest published mouse snapshot. Safe to call from any thread; the
+	 * - copy is taken under a lock, so it is never torn by a publish on another thread. */
+	MouseState					Mouse() const;
 
-	float						DeltaX();										// Gets the change in x-position between the last frame, and the current frame.
-	float						DeltaY();										// Gets the change in y-position between the last frame, and the current frame.
+	float						PosX() const { return Mouse().fPosX; }			// Gets the current x-position of the mouse pointer.
+	float						PosY() const { return Mouse().fPosY; }			// Gets the current y-position of the mouse pointer.
+	float						OldPosX() const { return Mouse().fOldPosX; }	// Gets the x-position of the mouse pointer, last frame.
+	float						OldPosY() const { return Mouse().fOldPosY; }	// Gets the y-position of the mouse pointer, last frame.
 
-	float						CenterX();										// Gets the center x-position of the window.
-	float						CenterY();										// Gets the center y-position of the window.
+	float						DeltaX() const { return Mouse().fDeltaX; }		// Gets the change in x-position between the last step, and the current step.
+	float						DeltaY() const { return Mouse().fDeltaY; }		// Gets the change in y-position between the last step, and the current step.
+
+	float						CenterX() const { return Mouse().fCenterX; }	// Gets the center x-position of the window.
+	float						CenterY() const { return Mouse().fCenterY; }	// Gets the center y-position of the window.
 
 	void						ToggleMouseCenter();							// Toggles between clamping the mouse pointer to the center of the window.
-	void						CenterMouse();
-	void						UpdateMousePosition();
 
+	/* Main thread only, as they read or move the window's pointer. */
+	void						CenterMouse();
 	Leadwerks::Vec3				GetMousePosition();
 	Leadwerks::Vec3				GetWindowCenter();
 
+	const BitSet256&			HeldKeys() const { return m_pressedKeys; }		// Gets the keys which have sent a key-down, but no key-up yet.
+
+	/* Main thread only; the window is only ever read by the thread that owns it. Reads the
+	 * - window's keys, buttons and pointer, queuing every change since the last sample, with
+	 * - the time it was seen, for the next Update. Called once a frame by the App. */
+	void						Sample();
+
+	/* Main thread only. While a pipelined main thread waits on the simulation, the window
+	 * - is also sampled at up to the given rate. The next Update applies the samples in
+	 * - order, so the frame still only sees the last state sampled and the total movement;
+	 * - the earlier timestamps only make the measured input latency more exact. Fails
+	 * - without a window, e.g. when headless. */
+	bool						StartSampling(unsigned nHz = 1000);
+	void						StopSampling();
+	bool						IsSampling() const { return m_bSampling.load(std::memory_order_acquire); }
+	void						SampleIdle();									// Samples if sampling, and a sample is due.
+
+	uint32_t					DroppedTransitions() const { return m_nDroppedTransitions.load(std::memory_order_relaxed); }
+
 protected:
 	InputManager(void);
 
 	void RegisterInputEvents(void);
 	void UnRegisterInputEvents(void);
 
-	void GenerateInputEvents(void);
+	void GenerateInputEvents(const BitSet256& currentKeys, uint32_t nCurrentButtons);
+	void DispatchEvents(void);
+
+	void PublishMouseState(void);
+
+	void DrainTransitions(void);
+	void PushTransition(const InputTransition& transition);
+
+	void OnMouseMove(Event_MouseMove& event);
+	void OnKeyDown(Event_KeyDown& event);
+	void OnKeyUp(Event_KeyUp& event);
 
-	void CheckMouseInput(int button);
-	void CheckKeyboardInput(int key);
+	/* Publishes a built-in input event on its Bus, writing it to the
+	 * - EventManager's recording first when one is running. */
+	template <typename E>
+	void Publish(E& event) {
+		m_pEventManager->RecordEvent(event, EVENT_CHANNEL_INPUT);
+		Bus<E>::Publish(event);
+	}
 
 private:
+	/* A built-in input event found by Update, held until the EventManager's next update
+	 * - publishes it, in the order found, as the input channel delivered it. */
+	struct QueuedInput {
+		enum Kind : uint8_t { MOUSE_HIT, MOUSE_DOWN, MOUSE_UP, KEY_HIT, KEY_DOWN, KEY_UP };
+
+		Kind					kind;
+		uint8_t					nCode;											// The key or mouse button.
+		float					fX;												// The mouse pointer's position, for buttons.
+		float					fY;
+	};
+
 	Leadwerks::Window*			m_pWindow;										// The main window handle.
 	Leadwerks::Context*			m_pContext;										// The main context handle.
 	EventManager*				m_pEventManager;
 
-	bool						m_bCenterMouse;									// Indicates whether the mouse pointer will be centered every frame.	
-
-	bool m_currentMousePressedState[6];
-	bool m_currentMouseState[6];
-	bool m_previousMouseState[6];
-
-	bool m_currentKeyboardPressedState[256];
-	bool m_currentKeyboardState[256];
-	bool m_previousKeyboardState[256];	
+	std::atomic<bool>			m_bCenterMouse;									// Indicates whether the mouse pointer will be centered every frame.	
+	bool						m_bMouseMovedThisFrame;							// Indicates whether a replayed mouse-move arrived this frame.
+	float						m_fPendingDeltaX;								// Movement gathered since the last step, for the next.
+	float						m_fPendingDeltaY;
+
+	MouseState					m_mouse;										// The snapshot being built this frame.
+	MouseState					m_published;									// The snapshot readers see.
+	mutable std::mutex			m_publishMutex;									// Guards m_published; held only to copy it.
+
+	Event_MouseHit				m_mouseHitEvent;								// The input events below are reused for every publish, rather
+	Event_MouseDown				m_mouseDownEvent;								// - than created through the event factory each time.
+	Event_MouseUp				m_mouseUpEvent;
+	Event_MouseMove				m_mouseMoveEvent;
+	Event_KeyHit				m_keyHitEvent;
+	Event_KeyDown				m_keyDownEvent;
+	Event_KeyUp					m_keyUpEvent;
+
+	BitSet256					m_previousKeys;									// The keys held down last frame.
+	BitSet256					m_pressedKeys;									// The keys which have sent a key-down, but no key-up yet.
+
+	uint32_t					m_nPreviousMouseButtons;						// As above, one bit per mouse button.
+	uint32_t					m_nPressedMouseButtons;
+
+	BitSet256					m_sampledKeys;									// The window as last sampled, by the main thread.
+	uint32_t					m_nSampledButtons;
+	float						m_fSampledX;									// Where the pointer was left; moved by re-centering.
+	float						m_fSampledY;
+
+	std::atomic<bool>			m_bSampling;
+	unsigned					m_nSampleHz;
+	uint64_t					m_nNextSampleMicros;							// The earliest an idle sample is taken again.
+	std::atomic<uint32_t>		m_nDroppedTransitions;							// Transitions lost because the queue was full.
+	RingBuffer<InputTransition, 4096> m_sampledTransitions;						// Written by Sample, read by Update, which may be on the simulation thread.
+	std::vector<InputTransition> m_transitions;									// The transitions drained this frame.
+	std::vector<QueuedInput>	m_queuedEvents;									// Found by Update, published by DispatchEvents.
 
 }; // end class.
 
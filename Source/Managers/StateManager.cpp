@@ -1,6 +1,7 @@
 #pragma once
 #include "StateManager.hpp"
 #include "../Utilities/Container.hpp"
+#include "../Utilities/Profiler.hpp"
 
 #include "../Utilities/Event.hpp"
 #include "EventManager.hpp"
@@ -8,15 +9,15 @@
 #include <cassert>
 
 StateManager::StateManager(void)
-	: m_bStateChangedThisFrame(false), m_pCurrentState(nullptr),
-	m_pContainer(nullptr), m_pEventManager(nullptr)
+	: m_bStateChangedThisFrame(false), m_bDeferred(false), m_pCurrentState(nullptr),
+	m_pContainer(nullptr), m_pEventManager(nullptr), m_bChangePending(false)
 {
 
 }
 
 StateManager::StateManager(Container* pContainer, EventManager* pEventManager) 
-	: m_bStateChangedThisFrame(false), m_pCurrentState(nullptr),
-	m_pContainer(pContainer), m_pEventManager(pEventManager)
+	: m_bStateChangedThisFrame(false), m_bDeferred(false), m_pCurrentState(nullptr),
+	m_pContainer(pContainer), m_pEventManager(pEventManager), m_bChangePending(false)
 {
 	Initialize(pContainer, pEventManager);
 }
@@ -25,26 +26,26 @@ StateManager::~StateManager(void) {
 
 	RemoveAllStates();
 
-	m_pEventManager->Unbind<StateManager, &StateManager::OnMouseDown>(this, Event_MouseDown::ClassType());
-	m_pEventManager->Unbind<StateManager, &StateManager::OnMouseUp>(this, Event_MouseUp::ClassType());
-	m_pEventManager->Unbind<StateManager, &StateManager::OnMouseHit>(this, Event_MouseHit::ClassType());
+	Bus<Event_MouseDown>::Unsubscribe<StateManager, &StateManager::OnMouseDown>(this);
+	Bus<Event_MouseUp>::Unsubscribe<StateManager, &StateManager::OnMouseUp>(this);
+	Bus<Event_MouseHit>::Unsubscribe<StateManager, &StateManager::OnMouseHit>(this);
 
-	m_pEventManager->Unbind<StateManager, &StateManager::OnKeyDown>(this, Event_KeyDown::ClassType());
-	m_pEventManager->Unbind<StateManager, &StateManager::OnKeyUp>(this, Event_KeyUp::ClassType());
-	m_pEventManager->Unbind<StateManager, &StateManager::OnKeyHit>(this, Event_KeyHit::ClassType());
+	Bus<Event_KeyDown>::Unsubscribe<StateManager, &StateManager::OnKeyDown>(this);
+	Bus<Event_KeyUp>::Unsubscribe<StateManager, &StateManager::OnKeyUp>(this);
+	Bus<Event_KeyHit>::Unsubscribe<StateManager, &StateManager::OnKeyHit>(this);
 
 	this->m_pEventManager = nullptr;
 }
 
 void StateManager::Configure(Container* pContainer)
 {
-	m_pEventManager->Bind<StateManager, &StateManager::OnMouseDown>(this, Event_MouseDown::ClassType());
-	m_pEventManager->Bind<StateManager, &StateManager::OnMouseUp>(this, Event_MouseUp::ClassType());
-	m_pEventManager->Bind<StateManager, &StateManager::OnMouseHit>(this, Event_MouseHit::ClassType());
+	Bus<Event_MouseDown>::Subscribe<StateManager, &StateManager::OnMouseDown>(this);
+	Bus<Event_MouseUp>::Subscribe<StateManager, &StateManager::OnMouseUp>(this);
+	Bus<Event_MouseHit>::Subscribe<StateManager, &StateManager::OnMouseHit>(this);
 
-	m_pEventManager->Bind<StateManager, &StateManager::OnKeyDown>(this, Event_KeyDown::ClassType());
-	m_pEventManager->Bind<StateManager, &StateManager::OnKeyUp>(this, Event_KeyUp::ClassType());
-	m_pEventManager->Bind<StateManager, &StateManager::OnKeyHit>(this, Event_KeyHit::ClassType());
+	Bus<Event_KeyDown>::Subscribe<StateManager, &StateManager::OnKeyDown>(this);
+	Bus<Event_KeyUp>::Subscribe<StateManager, &StateManager::OnKeyUp>(this);
+	Bus<Event_KeyHit>::Subscribe<StateManager, &StateManager::OnKeyHit>(this);
 }
 
 void StateManager::Initialize(Container* pContainer, EventManager* pEventManager)
@@ -55,6 +56,20 @@ void StateManager::Initialize(Container* pContainer, EventManager* pEventManager
 
 void StateManager::preUpdate(void)
 { 
+	PROFILE_SCOPE("StateManager::preUpdate");
+
+	// < A preloaded state is switched to at the start of the first frame
+	// * after it is ready, so the switch itself is a single Load.
+	if (this->m_bChangePending) {
+
+		auto iter = this->m_preloads.find(this->m_pendingChange);
+		if (iter == this->m_preloads.end() || iter->second->IsReady()) {
+
+			this->m_bChangePending = false;
+			ChangeState(this->m_pendingChange);
+		}
+	}
+
 	if (this->StateChangedThisFrame()) { return; }
 
 	if (this->m_pCurrentState != nullptr) { m_pCurrentState->preUpdate(); }
@@ -63,156 +78,373 @@ void StateManager::preUpdate(void)
 
 void StateManager::Update(float dt) 
 {
+	PROFILE_SCOPE("StateManager::Update");
+
 	if (this->StateChangedThisFrame()) { return; }
 
-	if (this->m_pCurrentState != nullptr) { 
-		
-        if (!this->m_pCurrentState->Update(dt))
-        {
-            this->CloseCurrentState();
-        }
+	// < Suspended states are updated first, at their own reduced rate.
+	size_t index = 0;
+	while (index + 1 < this->m_stack.size()) {
+
+		StackEntry& entry = this->m_stack[index];
+		State* pState = entry.pState;
+
+		if (entry.bClosing) { index += 1; continue; }
+		unsigned nInterval = pState->SuspendedUpdateInterval();
+
+		if (nInterval != 0) {
+			entry.nSkippedFrames += 1;
+			entry.fSkippedTime += dt;
+		}
+
+		if (nInterval == 0 || entry.nSkippedFrames < nInterval) { index += 1; continue; }
+
+		float fElapsed = entry.fSkippedTime;
+		entry.nSkippedFrames = 0;
+		entry.fSkippedTime = 0.0f;
+
+		// < Update may push or remove states, moving the stack under the
+		// * entry, so only the copied pointer is used from here on.
+		if (pState->Update(fElapsed)) { index += 1; continue; }
+
+		RemoveFromStack(pState);
+		if (MarkClosing(index, pState)) { index += 1; }
+	}
+
+	// < A state that asks to close is closed by name, so asking again in a
+	// * later step, before a deferred close is applied, closes nothing else.
+	State* pState = this->m_pCurrentState;
+	if (pState == nullptr || this->m_stack.back().bClosing) { return; }
+
+	if (!pState->Update(dt)) {
+		CloseState(pState);
+		MarkClosing(this->m_stack.size() - 1, pState);
 	}
 
 }
 
 void StateManager::postUpdate(void)
 {
+	PROFILE_SCOPE("StateManager::postUpdate");
+
 	if (this->StateChangedThisFrame()) { return; }
 
 	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->postUpdate(); }
 
 }
 
+// < Every state on the stack renders and draws, bottom first, so an overlay
+// * is drawn over the states it suspended.
+
 void StateManager::preRender(void)
 {
+	PROFILE_SCOPE("StateManager::preRender");
+
 	if (this->StateChangedThisFrame()) { return; }
 
-	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->preRender(); }
+	for (size_t i = 0; i < this->m_stack.size(); i++) { this->m_stack[i].pState->preRender(); }
 
 }
 
 void StateManager::postRender(void) 
 { 
+	PROFILE_SCOPE("StateManager::postRender");
+
 	if (this->StateChangedThisFrame()) { return; }
 
-	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->postRender(); }
+	for (size_t i = 0; i < this->m_stack.size(); i++) { this->m_stack[i].pState->postRender(); }
 
 }
 
 void StateManager::Render(void)
 {
+	PROFILE_SCOPE("StateManager::Render");
+
 	if (this->StateChangedThisFrame()) { return; }
 
-	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->Render(); }
+	for (size_t i = 0; i < this->m_stack.size(); i++) { this->m_stack[i].pState->Render(); }
 
 }
 
 void StateManager::preDraw(void) 
 {
+	PROFILE_SCOPE("StateManager::preDraw");
+
 	if (this->StateChangedThisFrame()) { return; }
 
-	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->preDraw(); }
+	for (size_t i = 0; i < this->m_stack.size(); i++) { this->m_stack[i].pState->preDraw(); }
 
 }
 
 void StateManager::postDraw(void) 
 { 
+	PROFILE_SCOPE("StateManager::postDraw");
+
 	if (this->StateChangedThisFrame()) { return; }
 
-	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->postDraw(); }
+	for (size_t i = 0; i < this->m_stack.size(); i++) { this->m_stack[i].pState->postDraw(); }
 
 }
 
 void StateManager::Draw(void) {
+	PROFILE_SCOPE("StateManager::Draw");
+
 
-	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->Draw(); }
+	for (size_t i = 0; i < this->m_stack.size(); i++) { this->m_stack[i].pState->Draw(); }
 
 	this->m_bStateChangedThisFrame = false;
 }
 
 void StateManager::CloseCurrentState(void) { 
 
-	if (this->m_pCurrentState != nullptr) { 
+	if (Defer([this]() { CloseCurrentState(); })) { return; }
 
-		this->m_pCurrentState->Close(); 
-		this->m_pCurrentState = nullptr;
-	}
+	CloseTop(true);
 
 	this->m_bStateChangedThisFrame = false;
 
 }
 
+void StateManager::PopState(void) {
+
+	if (Defer([this]() { PopState(); })) { return; }
+
+	if (this->m_stack.empty()) { return; }
+
+	CloseTop(true);
+
+	this->m_bStateChangedThisFrame = true;
+
+}
+
 bool StateManager::StateChangedThisFrame(void) { return this->m_bStateChangedThisFrame; }
 
+void StateManager::ChangeState(StringId id) {
+
+	if (Defer([this, id]() { ChangeState(id); })) { return; }
+
+	auto iter = this->m_states.find(id);
+	assert(iter != this->m_states.end());
+	if (iter == this->m_states.end() || IsOnStack(iter->second)) { return; }
+
+	// < Replaces the top of the stack; any suspended states stay suspended.
+	CloseTop(false);
+	Enter(id);
+
+}
+
+void StateManager::PushState(StringId id) {
+
+	if (Defer([this, id]() { PushState(id); })) { return; }
+
+	auto iter = this->m_states.find(id);
+	assert(iter != this->m_states.end());
+	if (iter == this->m_states.end() || IsOnStack(iter->second)) { return; }
+
+	if (this->m_pCurrentState != nullptr) { this->m_pCurrentState->Suspend(); }
+
+	Enter(id);
+
+}
+
+void StateManager::Enter(StringId id) {
+
+	auto iter = this->m_states.find(id);
+	assert(iter != this->m_states.end());
+	if (iter == this->m_states.end()) { return; }
+
+	bool bPrepared = (this->m_preloads.find(id) != this->m_preloads.end());
+	FinishPreload(id);
+
+	StackEntry entry = { iter->second, 0, 0.0f, false };
+	this->m_stack.push_back(entry);
+	this->m_pCurrentState = iter->second;
+
+	// < A state that was not preloaded is configured and prepared here,
+	// * blocking this frame as before.
+	if (!bPrepared) {
+		StateProgress progress;
+
+		this->m_pCurrentState->Configure(this->m_pContainer);
+		this->m_pCurrentState->Prepare(progress);
+	}
+
+	this->m_pCurrentState->Load();
+
+	this->m_bStateChangedThisFrame = true;
+}
+
+void StateManager::CloseTop(bool bResumeNext) {
+
+	if (this->m_stack.empty()) { return; }
+
+	State* pState = this->m_stack.back().pState;
+	this->m_stack.pop_back();
+	this->m_pCurrentState = this->m_stack.empty() ? nullptr : this->m_stack.back().pState;
+
+	pState->Close();
+
+	if (bResumeNext && this->m_pCurrentState != nullptr) { this->m_pCurrentState->Resume(); }
+
+}
+
+void StateManager::RemoveFromStack(State* pState) {
+
+	if (Defer([this, pState]() { RemoveFromStack(pState); })) { return; }
+
+	for (size_t i = 0; i < this->m_stack.size(); i++) {
+
+		if (this->m_stack[i].pState != pState) { continue; }
+
+		if (i + 1 == this->m_stack.size()) { CloseTop(true); }
+		else {
+			this->m_stack.erase(this->m_stack.begin() + i);
+			pState->Close();
+		}
+
+		return;
+	}
+
+}
+
+void StateManager::CloseState(State* pState) {
+
+	if (Defer([this, pState]() { CloseState(pState); })) { return; }
+
+	if (!IsOnStack(pState)) { return; }
+
+	RemoveFromStack(pState);
+
+	this->m_bStateChangedThisFrame = false;
+
+}
+
+void StateManager::ApplyTransitions(void) {
+
+	PROFILE_SCOPE("StateManager::ApplyTransitions");
+
+	// < Transitions made while these are applied, e.g. by a state's Load,
+	// * are carried out straight away.
+	TransitionQueue transitions;
+	transitions.swap(this->m_transitions);
+
+	bool bDeferred = this->m_bDeferred;
+	this->m_bDeferred = false;
+
+	for (auto& transition : transitions) { transition(); }
+
+	this->m_bDeferred = bDeferred;
+
+}
+
+bool StateManager::IsOnStack(const State* pState) const {
+
+	for (size_t i = 0; i < this->m_stack.size(); i++) {
+		if (this->m_stack[i].pState == pState) { return true; }
+	}
+
+	return false;
+
+}
+
+bool StateManager::MarkClosing(size_t index, const State* pState) {
+
+	// < Deferred, the state is still on the stack until the queue is applied,
+	// * so it is marked instead, and not updated again until then.
+	if (index >= this->m_stack.size() || this->m_stack[index].pState != pState) { return false; }
+
+	this->m_stack[index].bClosing = true;
+	return true;
+
+}
+
+void StateManager::FinishPreload(StringId id, bool bRethrow) {
+
+	auto iter = this->m_preloads.find(id);
+	if (iter == this->m_preloads.end()) { return; }
+
+	// < Waits for the worker, if it is still running, and rethrows
+	// * anything Prepare threw unless the state is being thrown away. The
+	// * progress is kept alive until then, as the worker still reports to it.
+	std::shared_ptr<StateProgress> pProgress = iter->second;
+	this->m_preloads.erase(iter);
+
+	std::shared_future<void> future = pProgress->m_future;
+	future.wait();
+
+	if (bRethrow) { future.get(); }
+}
+
 void StateManager::RemoveAllStates(void) {
 
 	StateManager::StateMap states;
 
-	if (this->m_pCurrentState != nullptr) { CloseCurrentState(); }
+	// < Anything still queued is moot once every state is gone.
+	this->m_transitions.clear();
+
+	// < Close the whole stack, top first.
+	while (!this->m_stack.empty()) { CloseTop(false); }
+
+	this->m_bChangePending = false;
 
 	auto iter = this->m_states.begin();
 	while (iter != this->m_states.end()) {
 
-		SAFE_DELETE(iter->second);
+		FinishPreload(iter->first, false);
+		gStateFactory.Destroy(iter->second);
 
 		iter++;
 
 	}
 
-	this->m_states.empty();
+	this->m_states.clear();
 
 }
 
-void StateManager::OnMouseHit(BaseEventData* pData) 
+void StateManager::OnMouseHit(Event_MouseHit& event) 
 {
-	if (pData == nullptr || this->m_pCurrentState == nullptr) { return; }
-	auto event = static_cast<Event_MouseHit*>(pData);
+	if (this->m_pCurrentState == nullptr) { return; }
 
-	this->m_pCurrentState->OnMouseHit(event);
+	this->m_pCurrentState->OnMouseHit(&event);
 
 }
 
-void StateManager::OnMouseDown(BaseEventData* pData) 
+void StateManager::OnMouseDown(Event_MouseDown& event) 
 {
-	if (pData == nullptr || this->m_pCurrentState == nullptr) { return; }
-	auto event = static_cast<Event_MouseDown*>(pData);
+	if (this->m_pCurrentState == nullptr) { return; }
 
-	this->m_pCurrentState->OnMouseDown(event);
+	this->m_pCurrentState->OnMouseDown(&event);
 
 }
 
-void StateManager::OnMouseUp(BaseEventData* pData) 
+void StateManager::OnMouseUp(Event_MouseUp& event) 
 {
-	if (pData == nullptr || this->m_pCurrentState == nullptr) { return; }
-	auto event = static_cast<Event_MouseUp*>(pData);
+	if (this->m_pCurrentState == nullptr) { return; }
 
-	this->m_pCurrentState->OnMouseUp(event);
+	this->m_pCurrentState->OnMouseUp(&event);
 
 }
 
-void StateManager::OnKeyHit(BaseEventData* pData) 
+void StateManager::OnKeyHit(Event_KeyHit& event) 
 {
-	if (pData == nullptr || this->m_pCurrentState == nullptr) { return; }
-	auto event = static_cast<Event_KeyHit*>(pData);
+	if (this->m_pCurrentState == nullptr) { return; }
 
-	this->m_pCurrentState->OnKeyHit(event);
+	this->m_pCurrentState->OnKeyHit(&event);
 
 }
 
-void StateManager::OnKeyDown(BaseEventData* pData) 
+void StateManager::OnKeyDown(Event_KeyDown& event) 
 {
-	if (pData == nullptr || this->m_pCurrentState == nullptr) { return; }
-	auto event = static_cast<Event_KeyDown*>(pData);
+	if (this->m_pCurrentState == nullptr) { return; }
 
-	this->m_pCurrentState->OnKeyDown(event);
+	this->m_pCurrentState->OnKeyDown(&event);
 
 }
 
-void StateManager::OnKeyUp(BaseEventData* pData) 
+void StateManager::OnKeyUp(Event_KeyUp& event) 
 {
-	if (pData == nullptr || this->m_pCurrentState == nullptr) { return; }
-	auto event = static_cast<Event_KeyUp*>(pData);
+	if (this->m_pCurrentState == nullptr) { return; }
 
-	this->m_pCurrentState->OnKeyUp(event);
+	this->m_pCurrentState->OnKeyUp(&event);
 
 }
\ No newline at end of file
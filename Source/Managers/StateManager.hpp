@@ -14,6 +14,14 @@
                  interface for adding logical states to
                  an application, allowing the second
                  of application and game logic.
+                 States form a stack: a pushed state
+                 suspends the ones beneath it rather
+                 than closing them, and only the top
+                 state receives input.
+                 With a render thread, transitions are
+                 deferred: those asked for while the
+                 simulation runs are queued, and applied
+                 on the main thread while it waits.
 
     Functions: 1. template <typename T>
 	              void AddState(bool bChange = false);
@@ -36,12 +44,23 @@
 	
 	           8. bool StateChangedThisFrame(void);
 
+	           9. template <typename T>
+	              std::shared_ptr<const StateProgress> PreloadState(bool bChangeWhenReady = false);
+
+	          10. template <typename T>
+	              void PushState(void);
+
+	          11. void PopState(void);
+
+	          12. void ApplyTransitions(void);
+
 ---------------------------------------------------------*/
 
 #ifndef _STATE_MANAGER_HPP_
 	#define _STATE_MANAGER_HPP_
 	
 #pragma once
+#include "../Utilities/Bus.hpp"
 #include "../Utilities/Container.hpp"
 #include "../Utilities/Manager.hpp"
 #include "../Utilities/Macros.hpp"
@@ -50,14 +69,31 @@
 #include "EventManager.hpp"
 #include "../States/State.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <map>
+#include <functional>
+#include <memory>
+#include <vector>
 
 class StateManager : public Manager {
 
 	CLASS_TYPE(StateManager);
 
-	typedef std::map<std::string,  State*> StateMap;
+	typedef std::map<StringId, State*> StateMap;
+	typedef std::map<StringId, std::shared_ptr<StateProgress>> PreloadMap;
+
+	/* A state on the stack, with the frames it has skipped while suspended. */
+	struct StackEntry
+	{
+		State*                                 pState;
+		unsigned                               nSkippedFrames;
+		float                                  fSkippedTime;
+		bool                                   bClosing;                    // Asked to close; the close is queued.
+	};
+
+	typedef std::vector<StackEntry> StateStack;
+	typedef std::vector<std::function<void()>> TransitionQueue;
 
 public:								
                                 StateManager(Container* pContainer, EventManager* pEventManager);
@@ -85,6 +121,14 @@ public:
 	void                       RemoveAllStates(void);
 		
 	template <typename T> void ChangeState(void);
+
+	template <typename T> std::shared_ptr<const StateProgress> PreloadState(bool bChangeWhenReady = false);
+
+	template <typename T> void PushState(void);
+
+	void                       PopState(void);
+
+	size_t                     StackDepth(void) const { return this->m_stack.size(); }
 		
 	template <typename T> State* FetchState(void);
 		
@@ -94,6 +138,14 @@ public:
 	
 	bool                       StateChangedThisFrame(void);
 
+	// < With a render thread, states must only load and close on the main
+	// * thread, which owns the scene. Deferred, every transition asked for
+	// * is queued instead, to be applied by the main thread through
+	// * ApplyTransitions while the simulation waits for it.
+	void                       SetDeferred(bool bDeferred) { this->m_bDeferred = bDeferred; }
+	bool                       HasTransitions(void) const { return !this->m_transitions.empty(); }
+	void                       ApplyTransitions(void);
+
 protected:
 
 											   StateManager(void);
@@ -102,35 +154,61 @@ protected:
 	
 	template <typename T> StateMap::iterator   FetchStateInternal(void);
 
-	void                                       OnMouseHit(BaseEventData* pData);
-	void                                       OnMouseDown(BaseEventData* pData);
-	void                                       OnMouseUp(BaseEventData* pData);
+	void                                       ChangeState(StringId id);
+	void                                       PushState(StringId id);
+	void                                       FinishPreload(StringId id, bool bRethrow = true);
+
+	void                                       Enter(StringId id);
+	void                                       CloseTop(bool bResumeNext);
+	void                                       RemoveFromStack(State* pState);
+	void                                       CloseState(State* pState);
+	bool                                       IsOnStack(const State* pState) const;
+	bool                                       MarkClosing(size_t index, const State* pState);
+
+	// < Deferred, queues the transition and returns true; otherwise returns
+	// * false for it to be carried out now.
+	template <typename F> bool                 Defer(F transition);
 
-	void                                       OnKeyHit(BaseEventData* pData);
-	void                                       OnKeyDown(BaseEventData* pData);
-	void                                       OnKeyUp(BaseEventData* pData);
+	void                                       OnMouseHit(Event_MouseHit& event);
+	void                                       OnMouseDown(Event_MouseDown& event);
+	void                                       OnMouseUp(Event_MouseUp& event);
+
+	void                                       OnKeyHit(Event_KeyHit& event);
+	void                                       OnKeyDown(Event_KeyDown& event);
+	void                                       OnKeyUp(Event_KeyUp& event);
 
 private:	
 
 	Container*                                 m_pContainer;
 	EventManager*                              m_pEventManager;
 
-	bool                                       m_bStateChangedThisFrame;
+	std::atomic<bool>                          m_bStateChangedThisFrame;   // Cleared by Draw, which may be on the render thread.
+
+	bool                                       m_bDeferred;
+	TransitionQueue                            m_transitions;               // Queued while deferred, oldest first.
 	
-	State*                                     m_pCurrentState;
+	State*                                     m_pCurrentState;             // The top of the stack, or nullptr.
+	StateStack                                 m_stack;                     // Active states, bottom first.
 
 	StateMap                                   m_states;	
 
+	PreloadMap                                 m_preloads;                  // States being prepared on a worker thread.
+	StringId                                   m_pendingChange;             // The preloading state to change to once ready.
+	bool                                       m_bChangePending;
+
 }; // < end class.
 	
 template <typename T>
 void StateManager::AddState(bool bChange) {
 
-	std::string type = T::ClassType();
+	// < The handle is fixed once the type is registered, so it is only
+	// * looked up by name until then.
+	static FactoryHandle handle = INVALID_FACTORY_HANDLE;
+	if (handle == INVALID_FACTORY_HANDLE) { handle = gStateFactory.Resolve(T::ClassType()); }
 
-	T* newState = (T*)(gStateFactory.Create(type));
+	T* newState = (T*)(gStateFactory.Create(handle));
 
-	auto key = std::make_pair(type, newState);
+	auto key = std::make_pair(T::ClassId(), newState);
 
 	auto it = this->m_states.insert(key);
 
@@ -141,10 +219,17 @@ void StateManager::AddState(bool bChange) {
 template <typename T>
 void StateManager::RemoveState(void) {
 
+	if (Defer([this]() { RemoveState<T>(); })) { return; }
+
 	auto it = FetchStateInternal<T>();
 	if (it == this->m_states.end()) { return; }
+
+	FinishPreload(it->first, false);
+	if (this->m_bChangePending && this->m_pendingChange == it->first) { this->m_bChangePending = false; }
+
+	RemoveFromStack(it->second);
 	
-	SAFE_DELETE(it->second);
+	gStateFactory.Destroy(it->second);
 
 	this->m_states.erase(it);
 
@@ -153,18 +238,59 @@ void StateManager::RemoveState(void) {
 template <typename T>
 void StateManager::ChangeState(void) {
 
-	if (this->m_pCurrentState != nullptr) 
-	{
-		CloseCurrentState();
-	}
+	ChangeState(T::ClassId());
+}
+
+template <typename T>
+void StateManager::PushState(void) {
+
+	if (!IsStatePresent<T>()) { AddState<T>(); }
+
+	PushState(T::ClassId());
+}
+
+template <typename T>
+std::shared_ptr<const StateProgress> StateManager::PreloadState(bool bChangeWhenReady) {
+
+	if (!IsStatePresent<T>()) { AddState<T>(); }
+
+	StringId id = T::ClassId();
+	if (bChangeWhenReady) { this->m_pendingChange = id; this->m_bChangePending = true; }
 
-	this->m_pCurrentState = FetchState<T>();
-	assert(this->m_pCurrentState != nullptr);
+	auto iter = this->m_preloads.find(id);
+	if (iter != this->m_preloads.end()) { return iter->second; }
 
-	this->m_pCurrentState->Configure(this->m_pContainer);
-	this->m_pCurrentState->Load();
+	State* pState = FetchState<T>();
+	assert(!IsOnStack(pState));
+
+	// < Dependencies are resolved here, on the main thread; only Prepare
+	// * runs on the worker.
+	pState->Configure(this->m_pContainer);
+
+	// < The caller shares the progress, so it stays valid after the state
+	// * has loaded. The worker is always waited on before this manager lets
+	// * go of it, so the worker only needs the raw pointer.
+	std::shared_ptr<StateProgress> pProgress = std::make_shared<StateProgress>();
+	StateProgress* pWorkerProgress = pProgress.get();
+
+	pProgress->m_future = std::async(std::launch::async, [pState, pWorkerProgress]() {
+		pState->Prepare(*pWorkerProgress);
+		pWorkerProgress->Report(1.0f);
+	}).share();
+
+	this->m_preloads.insert(std::make_pair(id, pProgress));
+
+	return pProgress;
+}
+
+template <typename F>
+bool StateManager::Defer(F transition) {
+
+	if (!this->m_bDeferred) { return false; }
+
+	this->m_transitions.push_back(transition);
+	return true;
 
-	this->m_bStateChangedThisFrame = true;
 }
 
 template <typename T>
@@ -180,9 +306,7 @@ template <typename T>
 template <typename T>
 StateManager::StateMap::iterator StateManager::FetchStateInternal(void) {
 
-	std::string type = T::ClassType();
-	
-	auto iter = this->m_states.find(type);
+	auto iter = this->m_states.find(T::ClassId());
 	
 	return iter;
 
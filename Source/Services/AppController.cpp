@@ -1,19 +1,48 @@
 #pragma once
 #include "Leadwerks.h"
 #include "AppController.hpp"
+#include "RenderBackend.hpp"
+#include "RenderPipeline.hpp"
 
 #include "../Common.hpp"
 #include "../Utilities/Container.hpp"
+#include "../Utilities/HitchDetector.hpp"
+#include "../Utilities/LatencyMonitor.hpp"
 #include "../Utilities/Macros.hpp"
+#include "../Utilities/Profiler.hpp"
+#include "../Utilities/StartupScheduler.hpp"
+#include "../Utilities/Timer.hpp"
 #include "../Utilities/WindowHandle.hpp"
 #include "../Utilities/ContextHandle.hpp"
 #include "../Utilities/WorldHandle.hpp"
 #include "../Utilities/CameraHandle.hpp"
 
+#include <chrono>
+
 const bool AppController::isFullScreen() const {
+	if (m_pWindow->getInst() == nullptr) { return false; }
+
 	return (bool)(m_pWindow->getInst()->FullScreen);
 }
 
+const bool AppController::isHeadless() const {
+	return m_bHeadless;
+}
+
+// < Leadwerks' speed is 1.0 at 60 frames per second; the simulation thread
+// * measures its own frames against the same mark.
+#define SIMULATION_FRAME_MICROS		16667.0f
+
+const bool AppController::isPipelined() const {
+	return m_pPipeline != nullptr && m_pPipeline->IsPipelined();
+}
+
+const float AppController::getInterpolationAlpha() const {
+	// < The timestep belongs to the simulation thread; the alpha it set for
+	// * the frame being rendered travels with that frame.
+	return (m_pPipeline != nullptr) ? m_pPipeline->Alpha() : 1.0f;
+}
+
 const std::string AppController::getAppName() const {
     return m_appName;
 }
@@ -50,136 +79,275 @@ const Leadwerks::Camera& AppController::getCamera() const {
     return (*m_pCamera->getInst());
 }
 
-const bool AppController::CreateWindowAndContext(std::string name, unsigned nX, unsigned nY, unsigned nWidth, unsigned nHeight, int windowFlags, int contextFlags) {
-    ReleaseWindowAndContext();
-
+WindowHandle* AppController::CreateWindowHandle(std::string name, unsigned nX, unsigned nY, unsigned nWidth, unsigned nHeight, int windowFlags) {
 	m_windowFlags = windowFlags;
+
+	// < Headless, every handle is a null one.
+	if (m_bHeadless) { return new WindowHandle(nullptr); }
+
+    WindowHandle* pWindow = new WindowHandle(Leadwerks::Window::Create(name, nX, nY, nWidth, nHeight, windowFlags));
+    if (pWindow->getInst() == nullptr) { std::cout << "Window creation was unsuccessful. \n"; SAFE_DELETE(pWindow); }
+
+    return pWindow;
+}
+
+ContextHandle* AppController::CreateContextHandle(WindowHandle* pWindow, int contextFlags) {
 	m_renderingContextFlags = contextFlags;
 
-    m_pWindow = new WindowHandle(Leadwerks::Window::Create(name, nX, nY, nWidth, nHeight, windowFlags));
-    if (m_pWindow->getInst()== nullptr) { std::cout << "Window creation was unsuccessful. \n"; return false; }
+	if (m_bHeadless) { return new ContextHandle(nullptr); }
 
-    m_pContext = new ContextHandle(Leadwerks::Context::Create(m_pWindow->getInst(), contextFlags));
-    if (m_pContext->getInst() == nullptr) { std::cout << "Rendering context creation was unsuccessful. \n"; return false; }
+    ContextHandle* pContext = new ContextHandle(Leadwerks::Context::Create(pWindow->getInst(), contextFlags));
+    if (pContext->getInst() == nullptr) { std::cout << "Rendering context creation was unsuccessful. \n"; SAFE_DELETE(pContext); }
 
-    return true;
+    return pContext;
 }
 
-const bool AppController::CreateWorld() {
-    ReleaseWorld();
+WorldHandle* AppController::CreateWorldHandle() {
+	if (m_bHeadless) { return new WorldHandle(nullptr); }
 
-    m_pWorld = new WorldHandle(Leadwerks::World::Create());
-    if (m_pWorld == nullptr) { std::cout << "World creation was unsuccessful. \n"; return false; }
+    WorldHandle* pWorld = new WorldHandle(Leadwerks::World::Create());
+    if (pWorld->getInst() == nullptr) { std::cout << "World creation was unsuccessful. \n"; SAFE_DELETE(pWorld); }
 
-    return true;
+    return pWorld;
 }
 
-const bool AppController::CreateCamera() {
-    ReleaseCamera();
+CameraHandle* AppController::CreateCameraHandle() {
+	if (m_bHeadless) { return new CameraHandle(nullptr); }
 
-    m_pCamera = new CameraHandle(Leadwerks::Camera::Create());
-    if (m_pCamera == nullptr) { std::cout << "Camera creation was unsuccessful. \n"; return false; }
+    CameraHandle* pCamera = new CameraHandle(Leadwerks::Camera::Create());
+    if (pCamera->getInst() == nullptr) { std::cout << "Camera creation was unsuccessful. \n"; SAFE_DELETE(pCamera); }
 
-    return true;
+    return pCamera;
 }
 
-void AppController::ReleaseApplication(void) {
-	m_pApp->Shutdown();	
+RenderPipeline* AppController::CreateRenderPipeline(ContextHandle* pContext, WorldHandle* pWorld) {
+	// < "-renderer null" runs the frame loop without drawing anything.
+	RenderBackend* pBackend = nullptr;
+	if (m_bHeadless || Leadwerks::System::GetProperty("renderer") == "null") { pBackend = new NullRenderBackend(); }
+	else { pBackend = new LeadwerksRenderBackend(pContext, pWorld); }
 
-	std::cout << "Application shutdown completed successfully. \n";
+	// < "-pipeline 1" simulates the next frame on its own thread while this
+	// * one renders the last.
+	RenderPipeline* pPipeline = new RenderPipeline(pBackend);
+	pPipeline->SetPipelined(Leadwerks::String::Int(Leadwerks::System::GetProperty("pipeline")) != 0);
+
+	return pPipeline;
+}
+
+void AppController::RunSimulation(void) {
+	uint64_t nLastMicros = Timer::Micros();
+
+	while (m_pPipeline->BeginFrame()) {
+		uint64_t nowMicros = Timer::Micros();
+		float dt = (float)(nowMicros - nLastMicros) / SIMULATION_FRAME_MICROS;
+		nLastMicros = nowMicros;
+
+		bool bRunning = Update(dt);
+
+		// < States asked to load or close this frame are loaded or closed
+		// * by the render thread, once it has rendered the frame; until then
+		// * the simulation waits.
+		m_pPipeline->EndFrame(dt, !bRunning, bRunning && m_pApp->HasTransitions());
+
+		if (!bRunning) { return; }
+	}
+}
+
+void AppController::StopSimulation(void) {
+	if (!m_simulation.joinable()) { return; }
+
+	m_pPipeline->Stop();
+	m_simulation.join();
 }
 
-void AppController::ReleaseWindowAndContext(void) {
-    SAFE_DELETE(m_pContext);
-    SAFE_DELETE(m_pWindow);
+void AppController::WaitForNextTick(void) {
+	// < Stepping once a frame, there is no tick to wait for; the run goes
+	// * as fast as it can.
+	if (m_timestep.TickRate() == 0) { return; }
+
+	float fRemaining = (1.0f - m_timestep.Alpha()) * m_timestep.StepDelta();
+	std::this_thread::sleep_for(std::chrono::microseconds((long long)(fRemaining * SIMULATION_FRAME_MICROS)));
 }
 
-void AppController::ReleaseWorld(void) {
-    SAFE_DELETE(m_pWorld);
+void AppController::Poll(void) {
+	// < The window belongs to the main thread, so it is only read here.
+	if (m_pWindow->getInst() != nullptr && m_pWindow->getInst()->Closed()) { m_bWindowClosed.store(true, std::memory_order_release); }
+
+	m_pApp->Poll();
 }
 
-void AppController::ReleaseCamera(void) {
-    SAFE_DELETE(m_pCamera);
+void AppController::ReleaseApplication(void) {
+	m_pApp->Shutdown();	
+
+	std::cout << "Application shutdown completed successfully. \n";
 }
 
 AppController::AppController(App *pApp)
     : m_pWindow(nullptr), m_pContext(nullptr), m_pWorld(nullptr), m_pCamera(nullptr), m_pApp(pApp)
-    , m_bExitAppThisFrame(false), m_windowFlags(0), m_renderingContextFlags(0) { }
+    , m_pContainer(nullptr), m_pPipeline(nullptr), m_pFrame(nullptr), m_bHeadless(false), m_bWindowClosed(false), m_nFrame(0), m_nMaxFrames(0), m_bExitAppThisFrame(false), m_bStartupReported(false), m_windowFlags(0), m_renderingContextFlags(0) { }
 
 AppController::~AppController(void) { Shutdown(); }
 
 const bool AppController::Initialize(const std::string appName, unsigned int ulX, unsigned int ulY, unsigned int nWidth, unsigned int nHeight, int windowFlags, int contextFlags) {
 
-	m_appName = appName;	
+	gStartupReport.Begin();
 
-    if (!CreateWindowAndContext(appName, ulX, ulY, nWidth, nHeight, windowFlags, contextFlags)) { return false; }
+	m_appName = appName;	
 
-    if (!CreateWorld() || !CreateCamera()) { return false; }
+	// < "-headless 1" runs without a window, context, world or camera, for
+	// * machines with no GPU. "-frames 600" closes the application after
+	// * that many frames, which is how a headless run usually ends.
+	m_bHeadless = (Leadwerks::String::Int(Leadwerks::System::GetProperty("headless")) != 0);
+	m_nMaxFrames = (uint64_t)(Leadwerks::String::Int(Leadwerks::System::GetProperty("frames")));
 
 	// < Create our DI Container.
 	m_pContainer = new Container();
 
-	// < Inject our application dependencies.
-	m_pContainer->Register<WindowHandle, WindowHandle>(m_pWindow);
-	m_pContainer->Register<ContextHandle, ContextHandle>(m_pContext);
-	m_pContainer->Register<WorldHandle, WorldHandle>(m_pWorld);
-	m_pContainer->Register<CameraHandle, CameraHandle>(m_pCamera);
+	// < Declare our application dependencies. Everything touching the
+	// * window or the renderer has to be created on the main thread; the
+	// * application's own services are created alongside them.
+	m_pContainer->Declare<WindowHandle>(SERVICE_MAIN_THREAD, [=](Container&) {
+		return CreateWindowHandle(appName, ulX, ulY, nWidth, nHeight, windowFlags);
+	});
+
+	m_pContainer->Declare<ContextHandle, WindowHandle>(SERVICE_MAIN_THREAD, [=](Container& container) {
+		return CreateContextHandle(container.Resolve<WindowHandle>(), contextFlags);
+	});
+
+	m_pContainer->Declare<WorldHandle>(SERVICE_MAIN_THREAD, [this](Container&) {
+		return CreateWorldHandle();
+	});
+
+	// < A camera is created in the current world.
+	m_pContainer->Declare<CameraHandle, WorldHandle>(SERVICE_MAIN_THREAD, [this](Container&) {
+		return CreateCameraHandle();
+	});
+
+	m_pContainer->Declare<RenderPipeline, ContextHandle, WorldHandle>(SERVICE_MAIN_THREAD, [this](Container& container) {
+		return CreateRenderPipeline(container.Resolve<ContextHandle>(), container.Resolve<WorldHandle>());
+	});
 
 	gApp->Configure(m_pContainer);
 
+	// < Create everything that was declared, independent services in parallel.
+	StartupScheduler scheduler(m_pContainer);
+	if (!scheduler.Run()) { return false; }
+
+	m_pWindow = m_pContainer->Resolve<WindowHandle>();
+	m_pContext = m_pContainer->Resolve<ContextHandle>();
+	m_pWorld = m_pContainer->Resolve<WorldHandle>();
+	m_pCamera = m_pContainer->Resolve<CameraHandle>();
+	m_pPipeline = m_pContainer->Resolve<RenderPipeline>();
+
+	// < States are stepped "-tickrate" times a second, 60 unless told
+	// * otherwise, with at most "-maxticks" steps to catch up in a frame.
+	// * "-tickrate 0" steps them once a frame instead.
+	std::string tickRate = Leadwerks::System::GetProperty("tickrate");
+	std::string maxTicks = Leadwerks::System::GetProperty("maxticks");
+
+	if (tickRate != "") { m_timestep.SetTickRate((unsigned)(Leadwerks::String::Int(tickRate))); }
+	if (maxTicks != "") { m_timestep.SetMaxSteps((unsigned)(Leadwerks::String::Int(maxTicks))); }
+
 	if (!gApp->Start()) { return false; }
 
+	// < From here on, this thread only renders.
+	if (m_pPipeline->IsPipelined()) { m_simulation = std::thread(&AppController::RunSimulation, this); }
+
     std::cout << "Application Controller initialization completed successfully. \n";
 
     return true;
 }
 
 void AppController::Shutdown() {
+	// < The simulation uses the application, so it stops first.
+	StopSimulation();
+
 	ReleaseApplication();
 
+	// < The Container owns our handles.
 	SAFE_DELETE(m_pContainer);
 
+	m_pWindow = nullptr;
+	m_pContext = nullptr;
+	m_pWorld = nullptr;
+	m_pCamera = nullptr;
+	m_pPipeline = nullptr;
+
     std::cout << "Application controller shutdown completed successfully. \n";    
 }
 
 void AppController::preUpdate() {
-    if (m_pWindow->getInst()->Closed()) { m_bExitAppThisFrame = true; }
+	PROFILE_SCOPE("preUpdate");
+
+    if (m_bWindowClosed.load(std::memory_order_acquire)) { m_bExitAppThisFrame = true; }
+    if (m_nMaxFrames != 0 && m_nFrame >= m_nMaxFrames) { m_bExitAppThisFrame = true; }
+
+    m_nFrame += 1;
 	
     m_pApp->preUpdate();
 }
 
 void AppController::postUpdate() {
+	PROFILE_SCOPE("postUpdate");
+
     m_pApp->postUpdate();
 }
 
 bool AppController::Update(float dt) {
+	PROFILE_SCOPE("Update");
+
+	// < Pipelined, the window is polled by the render thread instead.
+	if (!isPipelined()) { Poll(); }
+
 	preUpdate();
 
     if (m_bExitAppThisFrame) { return false; }
 
     m_bExitAppThisFrame = !m_pApp->Update(dt);
 
-    if (m_pWorld != nullptr) { m_pWorld->getInst()->Update(); }
+	// < Whatever the frame rate, the states see the same steps.
+	unsigned nSteps = m_timestep.Advance(dt);
+	while (nSteps-- != 0 && !m_bExitAppThisFrame) {
+		PROFILE_SCOPE("FixedUpdate");
+		m_bExitAppThisFrame = !m_pApp->FixedUpdate(m_timestep.StepDelta());
+	}
+
+	// < Rendering-side systems interpolate the frame by how far it is past
+	// * the last step.
+	m_pPipeline->SetAlpha(m_timestep.Alpha());
+
+	// < Pipelined, the world is updated by the render thread along with
+	// * the commands of this frame.
+    if (!m_pPipeline->IsPipelined()) { m_pPipeline->Backend()->UpdateWorld(); }
 
 	postUpdate();
 
+	// < Nothing waits on vsync when headless, so the frame waits for the
+	// * next tick instead of spinning.
+	if (m_bHeadless) { WaitForNextTick(); }
+
 	return true;
 }
 
 void AppController::preRender() {	
-	m_pContext->getInst()->SetColor(0.45f, 0.110f, 0.105f, 1.0f);
-    m_pContext->getInst()->Clear();
+	PROFILE_SCOPE("preRender");
+
+	m_pPipeline->Backend()->BeginRender();
 
     m_pApp->preRender();
 }
 
 void AppController::postRender() {
-    if (m_pWorld != nullptr) { m_pWorld->getInst()->Render(); }
+	PROFILE_SCOPE("postRender");
+
+	m_pPipeline->Backend()->RenderWorld();
 
     m_pApp->postRender();
 }
 
 void AppController::Render() {
+	PROFILE_SCOPE("Render");
+
 	preRender();
 
     m_pApp->Render();
@@ -188,22 +356,78 @@ void AppController::Render() {
 }
 
 void AppController::preDraw() {
-    m_pContext->getInst()->SetBlendMode(Leadwerks::Blend::Alpha);
+	PROFILE_SCOPE("preDraw");
+
+	m_pPipeline->Backend()->BeginDraw();
 
     m_pApp->preDraw();
 }
 
 void AppController::postDraw() {
+	PROFILE_SCOPE("postDraw");
+
     m_pApp->postDraw();
 
-    m_pContext->getInst()->SetBlendMode(Leadwerks::Blend::Solid);
-    m_pContext->getInst()->Sync(false);
+	m_pPipeline->Backend()->Present();
+
+	// < Any input seen before this point is now on its way to the screen.
+	// * Pipelined, that is the input the simulation took with this frame.
+	if (m_pFrame != nullptr) { gLatencyMonitor.Present(m_pFrame->nInputMicros, m_pFrame->nAppliedMicros); }
+	else { gLatencyMonitor.MarkPresented(); }
 }
 
 void AppController::Draw() {
-	preDraw();
+	{
+		PROFILE_SCOPE("Draw");
+
+		preDraw();
+
+		m_pApp->Draw();
+
+		postDraw();
+	}
+
+	// < Every scope of this frame has closed, so the frame can be summarised
+	// * and checked for a hitch.
+	gProfiler.EndFrame();
+	gHitchDetector.EndFrame();
+
+	// < Report how long startup took, once a state has been shown.
+	gStartupReport.MarkFirstFrame();
+	if (!m_bStartupReported && gStartupReport.IsComplete()) {
+		m_bStartupReported = true;
+		gStartupReport.Dump(std::cout);
+	}
+}
 
-    m_pApp->Draw();
+bool AppController::RenderPipelined() {
+	// < The window belongs to this thread, so it is polled here for the
+	// * simulation, and again while waiting on it.
+	Poll();
 
-	postDraw();
-}
\ No newline at end of file
+	RenderFrame* pFrame = m_pPipeline->AcquireFrame([this]() { m_pApp->Idle(); });
+	if (pFrame == nullptr) { return false; }
+
+	m_pFrame = pFrame;
+
+	m_pPipeline->Execute(*pFrame);
+	m_pPipeline->Backend()->UpdateWorld();
+
+	Render();
+
+	Draw();
+
+	m_pFrame = nullptr;
+
+	// < The simulation is waiting on this frame, so nothing else touches the
+	// * states while they load or close here, on the thread owning the scene.
+	if (pFrame->bSync) {
+		m_pApp->ApplyTransitions();
+		m_pPipeline->Resume();
+	}
+
+	bool bLast = pFrame->bLast;
+	m_pPipeline->ReleaseFrame(pFrame);
+
+	return !bLast;
+}
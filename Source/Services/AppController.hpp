@@ -20,6 +20,8 @@
                                         
                 2. void Shutdown(void);
 
+                3. bool RenderPipelined(void);
+
 ---------------------------------------------------------*/
 
 #ifndef _APP_CONTROLLER_HPP_
@@ -28,12 +30,19 @@
 #pragma once
 #include "leadwerks.h"
 
+#include "../Utilities/FixedTimestep.hpp"
+
+#include <atomic>
+#include <thread>
+
 class App;
 class Container;
 class WindowHandle;
 class ContextHandle;
 class WorldHandle;
 class CameraHandle;
+class RenderPipeline;
+struct RenderFrame;
 
 class AppController {
 public:
@@ -54,6 +63,9 @@ public:
     const Leadwerks::Vec2   		screen_lowerRight       (void) const;               // < Gets the lower-right screen coordinate.
 
     const bool              		isFullScreen            (void) const;               // < Indicates whether the application is currently in full-screen mode.
+    const bool              		isHeadless              (void) const;               // < Indicates whether the application runs without a window or renderer.
+    const bool              		isPipelined             (void) const;               // < Indicates whether the simulation runs on its own thread.
+    const float             		getInterpolationAlpha   (void) const;               // < Gets how far past the last fixed step the frame being rendered is.
 
 	const bool              		Initialize(const std::string appName, unsigned int ulX, unsigned int ulY	// < Performs bootstrapping of application.
 										, unsigned int nWidth, unsigned int nHeight, int windowFlags
@@ -72,17 +84,22 @@ public:
     void                    		Render                  (void);                     // < Performs all application 3D-rendering every frame.
     void                    		postRender              (void);
 
+    bool                    		RenderPipelined         (void);                     // < Renders and draws the next simulated frame; pipelined only.
+
 private:
-    const bool              		CreateWindowAndContext  (std::string name, unsigned nX = 0, unsigned nY = 0
-										, unsigned nWidth = 1024, unsigned nHeight = 768, int windowFlags = 0
-										, int contextFlags = 0);
-    const bool              		CreateWorld             (void);
-    const bool              		CreateCamera            (void);
+    WindowHandle*           		CreateWindowHandle      (std::string name, unsigned nX, unsigned nY
+										, unsigned nWidth, unsigned nHeight, int windowFlags);
+    ContextHandle*          		CreateContextHandle     (WindowHandle* pWindow, int contextFlags);
+    WorldHandle*            		CreateWorldHandle       (void);
+    CameraHandle*           		CreateCameraHandle      (void);
+    RenderPipeline*         		CreateRenderPipeline    (ContextHandle* pContext, WorldHandle* pWorld);
+
+    void                    		Poll                    (void);                     // < Reads the window; main thread only.
+    void                    		RunSimulation           (void);                     // < The simulation thread's loop.
+    void                    		StopSimulation          (void);
+    void                    		WaitForNextTick         (void);                     // < Paces a headless run to the tick rate.
 
 	void							ReleaseApplication		(void);
-    void                    		ReleaseWindowAndContext	(void);
-    void                    		ReleaseWorld            (void);
-    void                    		ReleaseCamera           (void);
 
     std::string             		m_appName;                                          // < Represents the describing name of the application.
     App*                    		m_pApp;                                             // < Application handle.
@@ -96,8 +113,18 @@ private:
     CameraHandle*      				m_pCamera;                                          // < Application's camera handle.
     
 	Container*						m_pContainer;
+    RenderPipeline*         		m_pPipeline;                                        // < Carries the simulation's changes to the renderer.
+    RenderFrame*            		m_pFrame;                                           // < The frame being rendered, when pipelined.
+    std::thread             		m_simulation;                                       // < Runs the simulation, when pipelined.
+    FixedTimestep           		m_timestep;                                         // < Steps the states at a fixed tick rate.
+
+    bool                    		m_bHeadless;                                        // < Indicates whether the window, context, world and camera are null.
+    std::atomic<bool>       		m_bWindowClosed;                                    // < Set by the main thread once the window has been closed.
+    uint64_t                		m_nFrame;                                           // < The number of frames updated so far.
+    uint64_t                		m_nMaxFrames;                                       // < The application closes after this many frames, or never if 0.
 
     bool                    		m_bExitAppThisFrame;                                // < Indicates whether the application will begin closing within the current frame.
+    bool                    		m_bStartupReported;                                 // < Indicates whether the time to the first frame has been reported.
     
 }; // end class.
 
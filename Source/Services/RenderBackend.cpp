@@ -0,0 +1,47 @@
+#pragma once
+#include "Leadwerks.h"
+#include "RenderBackend.hpp"
+
+#include "../Utilities/ContextHandle.hpp"
+#include "../Utilities/Profiler.hpp"
+#include "../Utilities/WorldHandle.hpp"
+
+void LeadwerksRenderBackend::Execute(const RenderCommand& command) {
+	if (command.pEntity == nullptr) { return; }
+
+	switch (command.type) {
+	case RenderCommand::RENDER_SET_POSITION: command.pEntity->SetPosition(command.vValue, command.bGlobal); break;
+	case RenderCommand::RENDER_SET_ROTATION: command.pEntity->SetRotation(command.vValue, command.bGlobal); break;
+	case RenderCommand::RENDER_MOVE:         command.pEntity->Move(command.vValue, command.bGlobal); break;
+	}
+}
+
+void LeadwerksRenderBackend::UpdateWorld() {
+	if (m_pWorld == nullptr) { return; }
+
+	PROFILE_SCOPE("World::Update");
+	m_pWorld->getInst()->Update();
+}
+
+void LeadwerksRenderBackend::BeginRender() {
+	m_pContext->getInst()->SetColor(0.45f, 0.110f, 0.105f, 1.0f);
+	m_pContext->getInst()->Clear();
+}
+
+void LeadwerksRenderBackend::RenderWorld() {
+	if (m_pWorld == nullptr) { return; }
+
+	PROFILE_SCOPE("World::Render");
+	m_pWorld->getInst()->Render();
+}
+
+void LeadwerksRenderBackend::BeginDraw() {
+	m_pContext->getInst()->SetBlendMode(Leadwerks::Blend::Alpha);
+}
+
+void LeadwerksRenderBackend::Present() {
+	m_pContext->getInst()->SetBlendMode(Leadwerks::Blend::Solid);
+
+	PROFILE_SCOPE("Context::Sync");
+	m_pContext->getInst()->Sync(false);
+}
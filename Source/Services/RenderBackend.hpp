@@ -0,0 +1,151 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: RenderBackend.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for RenderBackend service.
+                 The RenderBackend is everything the
+                 AppController asks of the renderer each
+                 frame: updating and rendering the world,
+                 clearing, blending and presenting, and
+                 carrying out the RenderCommands the
+                 simulation sent. The Leadwerks backend
+                 does the real work; the null backend
+                 only counts, so the frame loop can run
+                 without drawing anything.
+
+    Functions: 1. void Execute(const RenderCommand& command);
+
+               2. void UpdateWorld(void);
+
+               3. void BeginRender(void);
+
+               4. void RenderWorld(void);
+
+               5. void BeginDraw(void);
+
+               6. void Present(void);
+
+---------------------------------------------------------*/
+
+#ifndef _RENDER_BACKEND_HPP_
+    #define _RENDER_BACKEND_HPP_
+
+#pragma once
+#include "leadwerks.h"
+
+#include <cstdint>
+
+class ContextHandle;
+class WorldHandle;
+
+// < A change the simulation makes to a Leadwerks entity, carried out on the
+// * render side instead of by the simulation itself.
+struct RenderCommand
+{
+	enum eType
+	{
+		RENDER_SET_POSITION,
+		RENDER_SET_ROTATION,
+		RENDER_MOVE
+	};
+
+	eType                   type;
+	Leadwerks::Entity*      pEntity;
+	Leadwerks::Vec3         vValue;
+	bool                    bGlobal;
+
+	static RenderCommand SetPosition(Leadwerks::Entity* pEntity, const Leadwerks::Vec3& vPos, bool bGlobal = false) { return Make(RENDER_SET_POSITION, pEntity, vPos, bGlobal); }
+	static RenderCommand SetRotation(Leadwerks::Entity* pEntity, const Leadwerks::Vec3& vRot, bool bGlobal = false) { return Make(RENDER_SET_ROTATION, pEntity, vRot, bGlobal); }
+	static RenderCommand Move(Leadwerks::Entity* pEntity, const Leadwerks::Vec3& vVel, bool bGlobal = false) { return Make(RENDER_MOVE, pEntity, vVel, bGlobal); }
+
+private:
+
+	static RenderCommand Make(eType type, Leadwerks::Entity* pEntity, const Leadwerks::Vec3& vValue, bool bGlobal)
+	{
+		RenderCommand command;
+		command.type = type;
+		command.pEntity = pEntity;
+		command.vValue = vValue;
+		command.bGlobal = bGlobal;
+
+		return command;
+	}
+};
+
+class RenderBackend
+{
+public:
+
+	virtual ~RenderBackend(void) { }
+
+	virtual void Execute(const RenderCommand& command) = 0;
+
+	virtual void UpdateWorld(void) = 0;     // < World::Update.
+
+	virtual void BeginRender(void) = 0;     // < Clears the context.
+	virtual void RenderWorld(void) = 0;     // < World::Render.
+
+	virtual void BeginDraw(void) = 0;       // < Alpha blending for 2D-drawing.
+	virtual void Present(void) = 0;         // < Solid blending, then Context::Sync.
+
+}; // < end class.
+
+// < Renders through the application's Leadwerks context and world.
+class LeadwerksRenderBackend : public RenderBackend
+{
+public:
+
+	LeadwerksRenderBackend(ContextHandle* pContext, WorldHandle* pWorld) : m_pContext(pContext), m_pWorld(pWorld) { }
+
+	void Execute(const RenderCommand& command);
+
+	void UpdateWorld(void);
+
+	void BeginRender(void);
+	void RenderWorld(void);
+
+	void BeginDraw(void);
+	void Present(void);
+
+private:
+
+	ContextHandle*          m_pContext;
+	WorldHandle*            m_pWorld;
+
+}; // < end class.
+
+// < Renders nothing, but counts what it was asked to do.
+class NullRenderBackend : public RenderBackend
+{
+public:
+
+	NullRenderBackend(void) : m_nCommands(0), m_nFrames(0) { }
+
+	void Execute(const RenderCommand& command) { m_nCommands += 1; }
+
+	void UpdateWorld(void) { }
+
+	void BeginRender(void) { }
+	void RenderWorld(void) { }
+
+	void BeginDraw(void) { }
+	void Present(void) { m_nFrames += 1; }
+
+	uint64_t Commands(void) const { return m_nCommands; }
+	uint64_t Frames(void) const { return m_nFrames; }
+
+private:
+
+	uint64_t                m_nCommands;
+	uint64_t                m_nFrames;
+
+}; // < end class.
+
+#endif // _RENDER_BACKEND_HPP_
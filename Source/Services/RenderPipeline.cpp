@@ -0,0 +1,99 @@
+#pragma once
+#include "RenderPipeline.hpp"
+
+#include "../Utilities/LatencyMonitor.hpp"
+#include "../Utilities/Profiler.hpp"
+
+#include <chrono>
+#include <thread>
+
+RenderPipeline::RenderPipeline(RenderBackend* pBackend)
+	: m_pBackend(pBackend), m_bPipelined(false), m_bStopped(false), m_bWaiting(false), m_pBuilding(nullptr), m_fAlpha(1.0f)
+{
+	for (size_t i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		m_frames[i].commands.reserve(FRAME_COMMANDS);
+		m_free.TryPush(&m_frames[i]);
+	}
+}
+
+RenderPipeline::~RenderPipeline(void)
+{
+	SAFE_DELETE(m_pBackend);
+}
+
+void RenderPipeline::Submit(const RenderCommand& command)
+{
+	if (m_pBuilding != nullptr) { m_pBuilding->commands.push_back(command); }
+	else { m_pBackend->Execute(command); }
+}
+
+void RenderPipeline::SetAlpha(float fAlpha)
+{
+	if (m_pBuilding != nullptr) { m_pBuilding->fAlpha = fAlpha; }
+	else { m_fAlpha = fAlpha; }
+}
+
+bool RenderPipeline::BeginFrame(void)
+{
+	PROFILE_SCOPE("RenderPipeline::BeginFrame");
+
+	// < Frames are recycled rather than allocated, so a free one only turns
+	// * up once the render thread has finished with it.
+	RenderFrame* pFrame = nullptr;
+	while (!m_free.TryPop(pFrame))
+	{
+		if (IsStopped()) { return false; }
+		std::this_thread::yield();
+	}
+
+	pFrame->commands.clear();
+	pFrame->fAlpha = 1.0f;
+	m_pBuilding = pFrame;
+
+	return !IsStopped();
+}
+
+void RenderPipeline::EndFrame(float fDelta, bool bLast, bool bSync)
+{
+	if (m_pBuilding == nullptr) { return; }
+
+	m_pBuilding->fDelta = fDelta;
+	m_pBuilding->bLast = bLast;
+	m_pBuilding->bSync = bSync;
+
+	if (bSync) { m_bWaiting.store(true, std::memory_order_relaxed); }
+
+	// < The input this frame responds to is presented with it, not with
+	// * whichever frame the render thread happens to be drawing.
+	gLatencyMonitor.TakePending(m_pBuilding->nInputMicros, m_pBuilding->nAppliedMicros);
+
+	// < There are only ever as many frames as the queue holds, so this
+	// * cannot fail.
+	m_ready.TryPush(m_pBuilding);
+	m_pBuilding = nullptr;
+
+	if (!bSync) { return; }
+
+	// < Rare, and as long as whatever the render thread has to do, such as
+	// * loading a state, so this sleeps rather than spins.
+	PROFILE_SCOPE("RenderPipeline::Sync");
+	while (m_bWaiting.load(std::memory_order_acquire) && !IsStopped())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void RenderPipeline::Execute(const RenderFrame& frame)
+{
+	PROFILE_SCOPE("RenderPipeline::Execute");
+
+	m_fAlpha = frame.fAlpha;
+
+	for (auto& command : frame.commands) { m_pBackend->Execute(command); }
+}
+
+void RenderPipeline::ReleaseFrame(RenderFrame* pFrame)
+{
+	if (pFrame != nullptr) { m_free.TryPush(pFrame); }
+}
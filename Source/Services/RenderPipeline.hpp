@@ -0,0 +1,174 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: RenderPipeline.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for RenderPipeline service.
+                 The RenderPipeline carries RenderCommands
+                 from the simulation to the RenderBackend.
+                 By default each command is carried out
+                 as soon as it is submitted. Pipelined,
+                 the simulation fills a frame of commands
+                 on its own thread while the render thread
+                 draws the frame before it; the frames are
+                 handed over through lock-free queues, so
+                 neither side waits on a lock to do so.
+                 A frame may also ask the simulation to
+                 wait until the render thread has done
+                 what only it can, such as loading states.
+
+    Functions: 1. void Submit(const RenderCommand& command);
+
+               2. bool BeginFrame(void);
+
+               3. void EndFrame(float fDelta, bool bLast, bool bSync = false);
+
+               4. template <typename F>
+                  RenderFrame* AcquireFrame(F onWait);
+
+               5. void Execute(const RenderFrame& frame);
+
+               6. void ReleaseFrame(RenderFrame* pFrame);
+
+               7. void Resume(void);
+
+               8. float Alpha(void) const;
+
+    Example:
+
+        // < Simulation thread.
+        while (pPipeline->BeginFrame()) {
+            pPipeline->Submit(RenderCommand::Move(pCamera, vVel, true));
+            pPipeline->EndFrame(dt, false);
+        }
+
+        // < Render thread.
+        while (RenderFrame* pFrame = pPipeline->AcquireFrame()) {
+            pPipeline->Execute(*pFrame);
+            ...
+            if (pFrame->bSync) { ...; pPipeline->Resume(); }
+            pPipeline->ReleaseFrame(pFrame);
+        }
+
+---------------------------------------------------------*/
+
+#ifndef _RENDER_PIPELINE_HPP_
+    #define _RENDER_PIPELINE_HPP_
+
+#pragma once
+#include "RenderBackend.hpp"
+
+#include "../Utilities/Macros.hpp"
+#include "../Utilities/Profiler.hpp"
+#include "../Utilities/RingBuffer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// < Everything the simulation produced for one frame.
+struct RenderFrame
+{
+	std::vector<RenderCommand>  commands;
+	float                       fDelta;
+	float                       fAlpha;             // How far past the last simulation step this frame is.
+	uint64_t                    nInputMicros;       // The input this frame shows, for the LatencyMonitor, or 0.
+	uint64_t                    nAppliedMicros;
+	bool                        bLast;              // The simulation has stopped; nothing follows.
+	bool                        bSync;              // The simulation waits after this frame until Resume.
+};
+
+class RenderPipeline
+{
+	CLASS_TYPE(RenderPipeline);
+
+public:
+
+	// < The simulation may be building one frame while the render thread
+	// * draws the one before it, and no further ahead.
+	enum { FRAMES_IN_FLIGHT = 2, FRAME_COMMANDS = 256 };
+
+	/* Takes ownership of the backend */
+	explicit RenderPipeline(RenderBackend* pBackend);
+	~RenderPipeline(void);
+
+	RenderBackend* Backend(void) { return m_pBackend; }
+
+	/* Set before either side starts */
+	void SetPipelined(bool bPipelined) { m_bPipelined = bPipelined; }
+	bool IsPipelined(void) const { return m_bPipelined; }
+
+	/* Simulation side. Carried out now, or with the frame being built. */
+	void Submit(const RenderCommand& command);
+
+	/* Simulation side. How far past the last fixed step the frame is; render
+	   side systems read it back through Alpha to interpolate what they show. */
+	void SetAlpha(float fAlpha);
+
+	/* Render side. The alpha of the frame being rendered. */
+	float Alpha(void) const { return m_fAlpha; }
+
+	/* Simulation side, pipelined only. Waits for a free frame to build into;
+	   returns false once the pipeline has been stopped. */
+	bool BeginFrame(void);
+
+	/* With bSync, waits once the frame is handed over, until the render thread
+	   has rendered it and calls Resume, or the pipeline is stopped. */
+	void EndFrame(float fDelta, bool bLast, bool bSync = false);
+
+	/* Render side, pipelined only. Waits for the next finished frame, calling
+	   onWait each time round; returns nullptr once the pipeline has been stopped. */
+	template <typename F>
+	RenderFrame* AcquireFrame(F onWait);
+	RenderFrame* AcquireFrame(void) { return AcquireFrame([]() { }); }
+	void Execute(const RenderFrame& frame);
+	void ReleaseFrame(RenderFrame* pFrame);
+
+	/* Render side. Lets the simulation carry on after a frame with bSync. */
+	void Resume(void) { m_bWaiting.store(false, std::memory_order_release); }
+
+	/* Wakes and stops both sides */
+	void Stop(void) { m_bStopped.store(true, std::memory_order_release); }
+	bool IsStopped(void) const { return m_bStopped.load(std::memory_order_acquire); }
+
+private:
+
+	RenderBackend*                                  m_pBackend;
+	bool                                            m_bPipelined;
+	std::atomic<bool>                               m_bStopped;
+	std::atomic<bool>                               m_bWaiting;             // The simulation is waiting on a frame with bSync.
+
+	RenderFrame                                     m_frames[FRAMES_IN_FLIGHT];
+	RenderFrame*                                    m_pBuilding;            // The frame the simulation is filling, or nullptr.
+	float                                           m_fAlpha;               // The alpha of the frame being rendered.
+
+	RingBuffer<RenderFrame*, FRAMES_IN_FLIGHT>      m_free;                 // Render thread to simulation.
+	RingBuffer<RenderFrame*, FRAMES_IN_FLIGHT>      m_ready;                // Simulation to render thread.
+
+}; // < end class.
+
+template <typename F>
+RenderFrame* RenderPipeline::AcquireFrame(F onWait)
+{
+	PROFILE_SCOPE("RenderPipeline::AcquireFrame");
+
+	RenderFrame* pFrame = nullptr;
+	while (!m_ready.TryPop(pFrame))
+	{
+		if (IsStopped()) { return nullptr; }
+
+		onWait();
+		std::this_thread::yield();
+	}
+
+	return pFrame;
+}
+
+#endif // _RENDER_PIPELINE_HPP_
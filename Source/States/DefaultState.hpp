@@ -24,12 +24,16 @@
 #pragma once
 #include "State.hpp"
 #include "../Managers/InputManager.hpp"
+#include "../Services/RenderPipeline.hpp"
 
+#include "../Utilities/ActionMap.hpp"
 #include "../Utilities/CameraHandle.hpp"
 #include "../Utilities/Container.hpp"
 #include "../Utilities/Event.hpp"
 #include "../Utilities/IsoSurface.hpp"
 #include "../Utilities/Modeler.hpp"
+#include "../Utilities/Profiler.hpp"
+#include "../Utilities/ResourceCache.hpp"
 #include "../Utilities/VoxelBuffer.hpp"
 
 #include "../Components/World.hpp"
@@ -55,16 +59,16 @@ public:
 	                       DefaultState(void);
 
 	void                   Configure(Container* pContainer);
+	void                   Prepare(StateProgress& progress);
 	void                   Load(void);
 	void                   Close(void);
 
 	bool                   Update(float deltaTime);
 
-	void                   OnKeyDown(Event_KeyDown* pEvent);
-	void                   OnKeyUp(Event_KeyUp* pEvent);
-
 private:
 
+	void                   BuildIsosurface(StateProgress* pProgress);
+
 	Leadwerks::Light*	  m_pLight;
 	Leadwerks::Model*     m_pGround;
 
@@ -73,44 +77,51 @@ private:
 	VoxelBuffer<float>*    m_pBuffer;
 
     InputManager*          m_pInputMgr;
+	ActionMap*             m_pActionMap;
+	ResourceCache*         m_pCache;
+	RenderPipeline*        m_pPipeline;
 	CameraHandle*          m_pCameraHndl;
 
 	Components::World*     m_pWorld;
 
 	uint64_t               m_cameraDynamic;	    
 
+	bool                   m_bHasScene;            // False when headless; there is no renderer to hold a scene.
+	bool                   m_bModelCached;         // The isosurface model was cached when configured, so Prepare skips it.
+
 }; // < end class.
 
-DefaultState::DefaultState(void) { }
+DefaultState::DefaultState(void) : m_pLight(nullptr), m_pGround(nullptr), m_pIsosurface(nullptr), m_pModel(nullptr), m_pBuffer(nullptr),
+                                   m_bHasScene(false), m_bModelCached(false) { }
 
 void DefaultState::Configure(Container* pContainer)
 {
 	// < Here, we resolve some dependencies from the application container.
 	m_pCameraHndl = pContainer->Resolve<CameraHandle>();
     m_pInputMgr = pContainer->Resolve<InputManager>();
+	m_pActionMap = pContainer->Resolve<ActionMap>();
+	m_pCache = pContainer->Resolve<ResourceCache>();
+	m_pPipeline = pContainer->Resolve<RenderPipeline>();
+
+	// < The cache is main thread only, so it is asked here rather than in
+	// * Prepare, which may run on a worker.
+	m_bModelCached = m_pCache->Contains("DefaultState/Isosurface");
 }
 
-void DefaultState::Load(void) 
-{ 	
-	// < Add a light to our sample scene.
-	m_pLight = Leadwerks::DirectionalLight::Create();
-	m_pLight->SetRotation(35.0f, -35.0f, 0.0f);
+void DefaultState::Prepare(StateProgress& progress)
+{
+	PROFILE_SCOPE("DefaultState::Prepare");
 
-	// < Create a base for the sample scene.
-	m_pGround = Leadwerks::Model::Box(10.0f, 0.5f, 10.0f);	
-	m_pGround->Move(0.0f, 0.0f, 4.0f);
+	// < Coming back while the model is still cached, there is nothing to build.
+	if (m_bModelCached) { return; }
+
+	BuildIsosurface(&progress);
+}
+
+void DefaultState::BuildIsosurface(StateProgress* pProgress)
+{
+	PROFILE_SCOPE("DefaultState::BuildIsosurface");
 
-	// < Create the world for our components and a sample camera to move
-	// * about our scene.
-	m_pWorld = new Components::World();
-	m_cameraDynamic = Entities::CameraDynamic::Create(m_pWorld, m_pCameraHndl, "./Scripts/Camera.lua");    
-	
-	m_pCameraHndl->getInst()->SetDrawMode(DRAW_WIREFRAME);
-    
-	// < Set the input manager to reset the mouse-position to the center of the
-	// * screen every frame.
-	m_pInputMgr->ToggleMouseCenter();
-	
 	// < Initialize our isosurface and the voxel buffer we will be using.
 	m_pIsosurface = new IsoSurface<float>();
 	m_pBuffer = new VoxelBuffer<float>(NUM_VOXELS, NUM_VOXELS, NUM_VOXELS);
@@ -135,12 +146,11 @@ void DefaultState::Load(void)
 			} // end for
 	
 	modeler.Execute();
+	if (pProgress != nullptr) { pProgress->Report(0.5f); }
 
-	// < Generate our isosurface.
-	m_pModel = Leadwerks::Model::Create();	
-	m_pModel->Move(-4.0f, 0.0f, 0.0f);
-	unsigned nTriangles = m_pIsosurface->GenerateSurface(*m_pModel,
-		*m_pBuffer,
+	// < Polygonise our isosurface. The triangles are handed to Leadwerks
+	// * in Load.
+	unsigned nTriangles = m_pIsosurface->Polygonise(*m_pBuffer,
 		0.0,
 		CELLS_PER_ISOSURFACE,
 		CELLS_PER_ISOSURFACE,
@@ -151,6 +161,55 @@ void DefaultState::Load(void)
 
 }
 
+void DefaultState::Load(void) 
+{ 	
+	PROFILE_SCOPE("DefaultState::Load");
+
+	// < Scene assets come from the resource cache, so coming back to this
+	// * state shortly after leaving it reuses them rather than rebuilding.
+	// * Headless, the camera is a null one and only the simulation runs.
+	m_bHasScene = (m_pCameraHndl->getInst() != nullptr);
+
+	// < Create the world for our components and a sample camera to move
+	// * about our scene.
+	m_pWorld = new Components::World();
+	m_cameraDynamic = Entities::CameraDynamic::Create(m_pWorld, m_pCameraHndl, "./Scripts/Camera.lua");    
+
+	// < Set the input manager to reset the mouse-position to the center of the
+	// * screen every frame.
+	m_pInputMgr->ToggleMouseCenter();
+
+	if (!m_bHasScene) { return; }
+
+	// < Add a light to our sample scene.
+	m_pLight = m_pCache->Acquire<Leadwerks::DirectionalLight>("DefaultState/Light", []() {
+		Leadwerks::DirectionalLight* pLight = Leadwerks::DirectionalLight::Create();
+		pLight->SetRotation(35.0f, -35.0f, 0.0f);
+		return pLight;
+	});
+
+	// < Create a base for the sample scene.
+	m_pGround = m_pCache->Acquire<Leadwerks::Model>("DefaultState/Ground", []() {
+		Leadwerks::Model* pGround = Leadwerks::Model::Box(10.0f, 0.5f, 10.0f);
+		pGround->Move(0.0f, 0.0f, 4.0f);
+		return pGround;
+	});
+
+	m_pCameraHndl->getInst()->SetDrawMode(DRAW_WIREFRAME);
+
+	// < Build the model for the isosurface generated in Prepare. Should the
+	// * cached one have expired since, the isosurface is generated here.
+	m_pModel = m_pCache->Acquire<Leadwerks::Model>("DefaultState/Isosurface", [this]() {
+		if (m_pIsosurface == nullptr) { BuildIsosurface(nullptr); }
+
+		Leadwerks::Model* pModel = Leadwerks::Model::Create();
+		pModel->Move(-4.0f, 0.0f, 0.0f);
+		m_pIsosurface->BuildModel(*pModel);
+		return pModel;
+	});
+
+}
+
 void DefaultState::Close(void) 
 { 		
 	// < Set the input manager to allow the mouse pointer to freely
@@ -161,71 +220,51 @@ void DefaultState::Close(void)
 
 	m_pCameraHndl = nullptr;
     m_pInputMgr = nullptr;
-
-	SAFE_RELEASE(m_pLight);
-	SAFE_DELETE(m_pLight);
+	m_pActionMap = nullptr;
+	m_pPipeline = nullptr;
 
 	SAFE_DELETE(m_pIsosurface);
 	SAFE_DELETE(m_pBuffer);
 
-	SAFE_RELEASE(m_pGround);
-	SAFE_DELETE(m_pGround);
+	// < Hand the scene assets back to the cache; they are only destroyed
+	// * if nothing acquires them again within its grace period.
+	if (m_bHasScene) {
+		m_pCache->Release("DefaultState/Light");
+		m_pCache->Release("DefaultState/Ground");
+		m_pCache->Release("DefaultState/Isosurface");
+	}
 
-	SAFE_RELEASE(m_pModel);
-	SAFE_DELETE(m_pModel);
+	m_pLight = nullptr;
+	m_pGround = nullptr;
+	m_pModel = nullptr;
+	m_pCache = nullptr;
 
 }
 
 bool DefaultState::Update(float dt) 
 { 	
-    auto& inputComponent = m_pWorld->GetComponents<Components::Input>(m_pWorld, m_cameraDynamic)
-        ->front();
+	PROFILE_SCOPE("DefaultState::Update");
+
+	// < Held keys are turned into movement through the action map.
+	uint64_t nActions = m_pActionMap->Evaluate(m_pInputMgr->HeldKeys());
 
 	// < Check for any mouse movement. If there is any movement, we should
 	// * look to rotate the camera.
-    if (m_pInputMgr->DeltaX() < 0) { inputComponent.nMask |= INPUT_ROTATE_LEFT; }
-    if (m_pInputMgr->DeltaX() > 0) { inputComponent.nMask |= INPUT_ROTATE_RIGHT; }
+	const uint64_t nRotation = INPUT_ROTATE_LEFT | INPUT_ROTATE_RIGHT | INPUT_ROTATE_UP | INPUT_ROTATE_DOWN;
+	MouseState mouse = m_pInputMgr->Mouse();
 
-    if (m_pInputMgr->DeltaY() < 0) { inputComponent.nMask |= INPUT_ROTATE_DOWN; }
-    if (m_pInputMgr->DeltaY() > 0) { inputComponent.nMask |= INPUT_ROTATE_UP; }
+    if (mouse.fDeltaX < 0) { nActions |= INPUT_ROTATE_LEFT; }
+    if (mouse.fDeltaX > 0) { nActions |= INPUT_ROTATE_RIGHT; }
 
-	Entities::CameraDynamic::Update(m_pInputMgr, m_pWorld, dt);	
+    if (mouse.fDeltaY < 0) { nActions |= INPUT_ROTATE_DOWN; }
+    if (mouse.fDeltaY > 0) { nActions |= INPUT_ROTATE_UP; }
 
-	return true;
+	// < Write this frame's actions into every Input component in one pass.
+	m_pActionMap->Apply(m_pWorld, nActions, nRotation);
 
-}
+	Entities::CameraDynamic::Update(m_pInputMgr, m_pPipeline, m_pWorld, dt);	
 
-void DefaultState::OnKeyDown(Event_KeyDown* pEvent)
-{
-	auto& inputComponent = m_pWorld->GetComponents<Components::Input>(m_pWorld, m_cameraDynamic)
-		->front();    
-
-	// < Check for any key presses from the keyboard. If any key is pressed
-	// * we should look to move the camera.
-	if (pEvent->Key() == Leadwerks::Key::W) { inputComponent.nMask |= INPUT_MOVE_FORWARD; }
-	if (pEvent->Key() == Leadwerks::Key::A) { inputComponent.nMask |= INPUT_MOVE_LEFT; }
-	if (pEvent->Key() == Leadwerks::Key::S) { inputComponent.nMask |= INPUT_MOVE_BACKWARD; }
-	if (pEvent->Key() == Leadwerks::Key::D) { inputComponent.nMask |= INPUT_MOVE_RIGHT; }
-
-	if (pEvent->Key() == Leadwerks::Key::E) { inputComponent.nMask |= INPUT_MOVE_UP; }
-	if (pEvent->Key() == Leadwerks::Key::Q) { inputComponent.nMask |= INPUT_MOVE_DOWN; }
-
-}
-
-void DefaultState::OnKeyUp(Event_KeyUp* pEvent)
-{
-	auto& inputComponent = m_pWorld->GetComponents<Components::Input>(m_pWorld, m_cameraDynamic)
-		->front();
-
-	// < Just like key press however, here we pop the movement bitmask to signal 
-	// * a key release.
-	if (pEvent->Key() == Leadwerks::Key::W) { inputComponent.nMask &= ~INPUT_MOVE_FORWARD; }
-	if (pEvent->Key() == Leadwerks::Key::A) { inputComponent.nMask &= ~INPUT_MOVE_LEFT; }
-	if (pEvent->Key() == Leadwerks::Key::S) { inputComponent.nMask &= ~INPUT_MOVE_BACKWARD; }
-	if (pEvent->Key() == Leadwerks::Key::D) { inputComponent.nMask &= ~INPUT_MOVE_RIGHT; }
-
-	if (pEvent->Key() == Leadwerks::Key::E) { inputComponent.nMask &= ~INPUT_MOVE_UP; }
-	if (pEvent->Key() == Leadwerks::Key::Q) { inputComponent.nMask &= ~INPUT_MOVE_DOWN; }
+	return true;
 
 }
 
@@ -24,6 +24,32 @@
 #include "../Utilities/Event.hpp"
 #include "../Utilities/Factory.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <future>
+
+/* The progress of a state being prepared on a worker thread. Written by the
+ * - worker, read by the main thread. */
+class StateProgress {
+public:
+
+	StateProgress(void) : m_fProgress(0.0f) { }
+
+	void Report(float fProgress) { m_fProgress.store(fProgress, std::memory_order_release); }
+	float Progress(void) const { return m_fProgress.load(std::memory_order_acquire); }
+
+	bool IsReady(void) const { return m_future.valid() && m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+	void Wait(void) const { if (m_future.valid()) { m_future.wait(); } }
+
+private:
+
+	friend class StateManager;
+
+	std::atomic<float>          m_fProgress;    // 0 - 1.
+	std::shared_future<void>    m_future;       // Ready once Prepare has returned.
+
+}; // < end class.
+
 class State {
 public:
 
@@ -32,13 +58,38 @@ public:
 	State(void) { }
 
 	virtual void Configure(Container* pContainer) = 0;
+
+	// < The CPU-side part of loading, such as generating data. May run on a
+	// * worker thread, so it must not create or touch any Leadwerks objects.
+	virtual void Prepare(StateProgress& progress) { }
+
+	// < Runs on the main thread once Prepare has finished, and should only
+	// * hand the prepared data to Leadwerks. When the AppController is
+	// * pipelined, the main thread is the render thread: a transition asked
+	// * for by the simulation is applied there after the frame it was asked
+	// * in has been rendered, with the simulation waiting until it is done.
 	virtual void Load(void) { }
 	virtual void Close(void) { }
 
+	// < Called when another state is pushed on top of this one, and again
+	// * when that state is popped. A suspended state keeps its resources.
+	// * Like Load and Close, these run on the main thread.
+	virtual void Suspend(void) { }
+	virtual void Resume(void) { }
+
+	// < While suspended, the state is updated once every this many frames
+	// * with the time of all of them. 0 stops its updates altogether.
+	virtual unsigned SuspendedUpdateInterval(void) { return 0; }
+
 	virtual void preUpdate(void) { }
 	virtual void postUpdate(void) { }
 	virtual bool Update(float deltaTime) = 0;
 
+	// < When the AppController is pipelined, the update hooks and input
+	// * handlers run on the simulation thread, and the render and draw hooks
+	// * on the render thread while the next frame is being updated. Outside
+	// * of Load and Close, the scene should only be changed through the
+	// * RenderPipeline.
 	virtual void preRender(void) { }
 	virtual void postRender(void) { }
 	virtual void Render(void) { }
@@ -0,0 +1,187 @@
+#pragma once
+#include "Leadwerks.h"
+#include "ActionMap.hpp"
+
+#include "luatables/luatables.h"
+
+#include <sstream>
+
+namespace
+{
+	struct NamedKey { const char* cName; unsigned nKey; };
+	struct NamedAction { const char* cName; uint64_t nAction; };
+
+	// < Keys that are not a single letter or digit.
+	const NamedKey s_namedKeys[] =
+	{
+		{ "Space", Leadwerks::Key::Space },
+		{ "Shift", Leadwerks::Key::Shift },
+		{ "Control", Leadwerks::Key::Control },
+		{ "Escape", Leadwerks::Key::Escape },
+		{ "Enter", Leadwerks::Key::Enter },
+		{ "Tab", Leadwerks::Key::Tab },
+		{ "Up", Leadwerks::Key::Up },
+		{ "Down", Leadwerks::Key::Down },
+		{ "Left", Leadwerks::Key::Left },
+		{ "Right", Leadwerks::Key::Right }
+	};
+
+	const NamedAction s_namedActions[] =
+	{
+		{ "INPUT_MOVE_FORWARD", INPUT_MOVE_FORWARD },
+		{ "INPUT_MOVE_BACKWARD", INPUT_MOVE_BACKWARD },
+		{ "INPUT_MOVE_LEFT", INPUT_MOVE_LEFT },
+		{ "INPUT_MOVE_RIGHT", INPUT_MOVE_RIGHT },
+		{ "INPUT_MOVE_UP", INPUT_MOVE_UP },
+		{ "INPUT_MOVE_DOWN", INPUT_MOVE_DOWN },
+		{ "INPUT_ROTATE_LEFT", INPUT_ROTATE_LEFT },
+		{ "INPUT_ROTATE_RIGHT", INPUT_ROTATE_RIGHT },
+		{ "INPUT_ROTATE_UP", INPUT_ROTATE_UP },
+		{ "INPUT_ROTATE_DOWN", INPUT_ROTATE_DOWN },
+		{ "INPUT_ROLL_LEFT", INPUT_ROLL_LEFT },
+		{ "INPUT_ROLL_RIGHT", INPUT_ROLL_RIGHT },
+		{ "INPUT_ACTION_CROUCH", INPUT_ACTION_CROUCH },
+		{ "INPUT_ACTION_JUMP", INPUT_ACTION_JUMP },
+		{ "INPUT_ACTION_INTERACT", INPUT_ACTION_INTERACT },
+		{ "INPUT_ACTION_PRIMARY", INPUT_ACTION_PRIMARY },
+		{ "INPUT_ACTION_SECONDARY", INPUT_ACTION_SECONDARY }
+	};
+
+	// < Binds the action named by a string value, or by each entry of a
+	// * list value, to the given key. Returns the number of actions bound.
+	unsigned BindActions(ActionMap& actionMap, LuaTableNode& node, unsigned nKey, std::vector<std::string>& problems)
+	{
+		std::vector<std::string> names;
+
+		std::string cName = node.getDefault<std::string>("");
+		if (cName != "") { names.push_back(cName); }
+		else
+		{
+			int nCount = (int)(node.length());
+			for (int i = 1; i <= nCount; i++) { names.push_back(node[i].getDefault<std::string>("")); }
+		}
+
+		unsigned nBound = 0;
+		for (auto it = names.begin(); it != names.end(); it++)
+		{
+			uint64_t nAction;
+			if (!ActionMap::FindAction(*it, nAction))
+			{
+				problems.push_back("unknown action \"" + *it + "\"");
+				continue;
+			}
+
+			actionMap.Bind(nKey, nAction);
+			nBound += 1;
+		}
+
+		return nBound;
+	}
+}
+
+bool ActionMap::Load(const std::string& cScriptPath)
+{
+	Clear();
+	m_problems.clear();
+
+	LuaTable table = LuaTable::fromFile(cScriptPath.c_str());
+
+	LuaTableNode bindings = table["bindings"];
+	if (!bindings.exists())
+	{
+		m_problems.push_back("\"" + cScriptPath + "\" has no bindings table");
+		return false;
+	}
+
+	std::vector<LuaKey> keys = bindings.keys();
+	for (auto it = keys.begin(); it != keys.end(); it++)
+	{
+		unsigned nKey;
+
+		// < Keys are either named, e.g. W = ..., or given by code, e.g. [87] = ...
+		if (it->type == LuaKey::Integer)
+		{
+			if (it->int_value < 0 || it->int_value > 255)
+			{
+				std::ostringstream problem;
+				problem << "key code " << it->int_value << " is out of range";
+
+				m_problems.push_back(problem.str());
+				continue;
+			}
+
+			nKey = (unsigned)(it->int_value);
+
+			LuaTableNode node = bindings[it->int_value];
+			BindActions(*this, node, nKey, m_problems);
+		}
+		else
+		{
+			if (!FindKey(it->string_value, nKey))
+			{
+				m_problems.push_back("unknown key \"" + it->string_value + "\"");
+				continue;
+			}
+
+			LuaTableNode node = bindings[it->string_value.c_str()];
+			BindActions(*this, node, nKey, m_problems);
+		}
+	}
+
+	return true;
+}
+
+void ActionMap::Clear(void)
+{
+	for (unsigned i = 0; i < 256; i++) { m_table[i] = INPUT_NONE; }
+
+	m_nBound = INPUT_NONE;
+}
+
+void ActionMap::Rebuild(void)
+{
+	m_nBound = INPUT_NONE;
+	for (unsigned i = 0; i < 256; i++) { m_nBound |= m_table[i]; }
+}
+
+bool ActionMap::FindKey(const std::string& cName, unsigned& nKey)
+{
+	// < Single letters and digits share their key code with their
+	// * upper-case character.
+	if (cName.size() == 1)
+	{
+		char c = cName[0];
+		if (c >= 'a' && c <= 'z') { c = c - 'a' + 'A'; }
+
+		if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+		{
+			nKey = (unsigned)(c);
+			return true;
+		}
+	}
+
+	for (auto& named : s_namedKeys)
+	{
+		if (cName == named.cName)
+		{
+			nKey = named.nKey;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ActionMap::FindAction(const std::string& cName, uint64_t& nAction)
+{
+	for (auto& named : s_namedActions)
+	{
+		if (cName == named.cName)
+		{
+			nAction = named.nAction;
+			return true;
+		}
+	}
+
+	return false;
+}
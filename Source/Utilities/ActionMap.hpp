@@ -0,0 +1,127 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: ActionMap.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for ActionMap utility.
+                 The ActionMap turns held keys into
+                 InputDictionary actions. Bindings are
+                 read from a Lua table and compiled into
+                 a 256-entry table of action masks, so a
+                 frame's actions are the OR of the masks
+                 of every held key. The result is written
+                 straight into each Input component.
+
+    Functions: 1. bool Load(const std::string& cScriptPath);
+
+               2. void Bind(unsigned nKey, uint64_t nActions);
+
+               3. uint64_t Evaluate(const BitSet256& keys) const;
+
+               4. void Apply(Components::World* pWorld, uint64_t nActions, uint64_t nOwned = 0) const;
+
+    Example:
+
+        -- Scripts/Input.lua
+        Input =
+        {
+            bindings =
+            {
+                W = "INPUT_MOVE_FORWARD",
+                Space = { "INPUT_MOVE_UP", "INPUT_ACTION_JUMP" }
+            }
+        }
+
+        return Input;
+
+---------------------------------------------------------*/
+
+#ifndef _ACTION_MAP_HPP_
+	#define _ACTION_MAP_HPP_
+
+#pragma once
+#include "Macros.hpp"
+#include "BitSet256.hpp"
+#include "LatencyMonitor.hpp"
+
+#include "../Components/Input.hpp"
+#include "../Components/World.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ActionMap
+{
+	CLASS_TYPE(ActionMap);
+
+public:
+
+	ActionMap(void) { Clear(); }
+
+	/* Replaces the current bindings with those in the given script's
+	   "bindings" table. Unknown keys or actions are skipped and listed in
+	   Problems; Load may run on a worker, so it leaves reporting them to
+	   the caller. */
+	bool Load(const std::string& cScriptPath);
+
+	const std::vector<std::string>& Problems(void) const { return m_problems; }
+
+	void Bind(unsigned nKey, uint64_t nActions) { m_table[nKey & 0xff] |= nActions; m_nBound |= nActions; }
+	void Unbind(unsigned nKey) { m_table[nKey & 0xff] = INPUT_NONE; Rebuild(); }
+	void Clear(void);
+
+	/* The actions of every held key */
+	uint64_t Evaluate(const BitSet256& keys) const
+	{
+		uint64_t nActions = INPUT_NONE;
+		keys.ForEach([this, &nActions](unsigned nKey) { nActions |= m_table[nKey]; });
+
+		return nActions;
+	}
+
+	/* Writes the given actions into every Input component of the World.
+	   Only the bits this map owns are replaced; any other bits are kept.
+	   Input is only marked as applied when it mapped to an action, or its
+	   release changed a component, so an unbound key is not measured as
+	   though it had reached one. */
+	void Apply(Components::World* pWorld, uint64_t nActions, uint64_t nOwned = 0) const
+	{
+		uint64_t nKeep = ~(m_nBound | nOwned);
+		bool bChanged = false;
+
+		pWorld->ForEachComponent<Components::Input>([nActions, nKeep, &bChanged](Components::Input& input) {
+			uint64_t nMask = (input.nMask & nKeep) | nActions;
+
+			bChanged |= (nMask != input.nMask);
+			input.nMask = nMask;
+		});
+
+		if (nActions != INPUT_NONE || bChanged) { gLatencyMonitor.MarkApplied(); }
+	}
+
+	uint64_t Actions(unsigned nKey) const { return m_table[nKey & 0xff]; }
+	uint64_t Bound(void) const { return m_nBound; }
+
+	/* Name lookups used when loading; return false if the name is unknown */
+	static bool FindKey(const std::string& cName, unsigned& nKey);
+	static bool FindAction(const std::string& cName, uint64_t& nAction);
+
+private:
+
+	void Rebuild(void);
+
+	uint64_t    m_table[256];       // The action mask of each key.
+	uint64_t    m_nBound;           // Every action bound to at least one key.
+
+	std::vector<std::string> m_problems;    // What the last Load skipped, and why.
+
+}; // < end class.
+
+#endif // _ACTION_MAP_HPP_
@@ -0,0 +1,64 @@
+#pragma once
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(ALLOCATION_COUNTER_ENABLED)
+
+// < Plain globals rather than function statics; operator new may run before
+// * any other static is constructed, and zero-initialised atomics need no constructor.
+static std::atomic<uint64_t> s_nAllocations;
+static std::atomic<uint64_t> s_nBytes;
+
+// < As the standard operator new does: on failure, the new_handler is given
+// * the chance to free memory before trying again, and without one the
+// * allocation fails with std::bad_alloc.
+static void* CountedAlloc(size_t nSize)
+{
+	s_nAllocations.fetch_add(1, std::memory_order_relaxed);
+	s_nBytes.fetch_add(nSize, std::memory_order_relaxed);
+
+	if (nSize == 0) { nSize = 1; }
+
+	for (;;)
+	{
+		void* p = malloc(nSize);
+		if (p != nullptr) { return p; }
+
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr) { throw std::bad_alloc(); }
+
+		handler();
+	}
+}
+
+static void* CountedAllocNoThrow(size_t nSize) noexcept
+{
+	try { return CountedAlloc(nSize); }
+	catch (...) { return nullptr; }
+}
+
+void* operator new(size_t nSize) { return CountedAlloc(nSize); }
+void* operator new[](size_t nSize) { return CountedAlloc(nSize); }
+
+void* operator new(size_t nSize, const std::nothrow_t&) noexcept { return CountedAllocNoThrow(nSize); }
+void* operator new[](size_t nSize, const std::nothrow_t&) noexcept { return CountedAllocNoThrow(nSize); }
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+uint64_t AllocationCounter::Count(void) { return s_nAllocations.load(std::memory_order_relaxed); }
+uint64_t AllocationCounter::Bytes(void) { return s_nBytes.load(std::memory_order_relaxed); }
+
+#else
+
+uint64_t AllocationCounter::Count(void) { return 0; }
+uint64_t AllocationCounter::Bytes(void) { return 0; }
+
+#endif
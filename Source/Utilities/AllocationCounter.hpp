@@ -0,0 +1,65 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: AllocationCounter.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for AllocationCounter utility.
+                 The AllocationCounter namespace counts
+                 every allocation made through the global
+                 operator new, on any thread, so the work
+                 of a frame can be measured by taking the
+                 difference between two readings.
+                 Replacing operator new affects the whole
+                 program, so it is only on by default in
+                 debug builds; defining
+                 ALLOCATION_COUNTER_ENABLED turns it on in
+                 any build, and ALLOCATION_COUNTER_DISABLED
+                 turns it off. When off, operator new is
+                 left untouched and Enabled() is false.
+
+    Functions: 1. bool Enabled(void);
+
+               2. uint64_t Count(void);
+
+               3. uint64_t Bytes(void);
+
+---------------------------------------------------------*/
+
+#ifndef _ALLOCATION_COUNTER_HPP_
+	#define _ALLOCATION_COUNTER_HPP_
+
+#pragma once
+#include <cstdint>
+
+#if defined(_DEBUG) && !defined(ALLOCATION_COUNTER_DISABLED) && !defined(ALLOCATION_COUNTER_ENABLED)
+	#define ALLOCATION_COUNTER_ENABLED
+#endif
+
+namespace AllocationCounter
+{
+	// < Whether allocations are counted in this build; when not, the
+	// * readings below are meaningless and should be shown as such.
+	inline bool Enabled(void)
+	{
+#if defined(ALLOCATION_COUNTER_ENABLED)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// < The number of allocations made so far; always 0 when disabled.
+	uint64_t Count(void);
+
+	// < The total bytes requested by those allocations.
+	uint64_t Bytes(void);
+
+} // < end namespace.
+
+#endif // _ALLOCATION_COUNTER_HPP_
@@ -0,0 +1,188 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: BitSet256.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for BitSet256 utility.
+                 The BitSet256 class packs 256 flags,
+                 such as the state of every key, into
+                 four 64-bit words. Set operations use
+                 SSE2 where available, and ForEach visits
+                 only the set bits.
+
+    Functions: 1. static BitSet256 FromBools(const bool* pValues);
+
+               2. BitSet256 AndNot(const BitSet256& other) const;
+
+               3. template <typename F>
+                  void ForEach(F onBit) const;
+
+               4. bool Test(unsigned nBit) const;
+
+---------------------------------------------------------*/
+
+#ifndef _BITSET256_HPP_
+	#define _BITSET256_HPP_
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define BITSET256_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+class BitSet256
+{
+public:
+
+	BitSet256(void) { Clear(); }
+
+	/* Packs 256 bools into bits; any non-zero byte counts as set */
+	static BitSet256 FromBools(const bool* pValues)
+	{
+		BitSet256 result;
+
+#if defined(BITSET256_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+
+		// < Each word is built in a local from four 16-bit masks, rather than
+		// * writing the masks through a uint16_t* into it.
+		for (int w = 0; w < 4; w++)
+		{
+			uint64_t word = 0;
+
+			for (int i = 0; i < 4; i++)
+			{
+				__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pValues + (w * 4 + i) * 16));
+				__m128i unset = _mm_cmpeq_epi8(bytes, zero);
+				word |= (uint64_t)((uint16_t)(~_mm_movemask_epi8(unset))) << (i * 16);
+			}
+
+			result.m_words[w] = word;
+		}
+#else
+		for (unsigned i = 0; i < 256; i++)
+		{
+			if (pValues[i]) { result.Set(i); }
+		}
+#endif
+
+		return result;
+	}
+
+	void Clear(void) { memset(m_words, 0, sizeof(m_words)); }
+
+	void Set(unsigned nBit) { m_words[nBit >> 6] |= (1ull << (nBit & 63)); }
+	void Reset(unsigned nBit) { m_words[nBit >> 6] &= ~(1ull << (nBit & 63)); }
+	bool Test(unsigned nBit) const { return (m_words[nBit >> 6] & (1ull << (nBit & 63))) != 0; }
+
+	bool Any(void) const { return (m_words[0] | m_words[1] | m_words[2] | m_words[3]) != 0; }
+
+	/* this & ~other */
+	BitSet256 AndNot(const BitSet256& other) const
+	{
+		BitSet256 result(Uninitialised);
+#if defined(BITSET256_SSE2)
+		for (int i = 0; i < 2; i++) { result.Store(i, _mm_andnot_si128(other.Load(i), Load(i))); }
+#else
+		for (int i = 0; i < 4; i++) { result.m_words[i] = m_words[i] & ~other.m_words[i]; }
+#endif
+		return result;
+	}
+
+	BitSet256 operator& (const BitSet256& other) const
+	{
+		BitSet256 result(Uninitialised);
+#if defined(BITSET256_SSE2)
+		for (int i = 0; i < 2; i++) { result.Store(i, _mm_and_si128(Load(i), other.Load(i))); }
+#else
+		for (int i = 0; i < 4; i++) { result.m_words[i] = m_words[i] & other.m_words[i]; }
+#endif
+		return result;
+	}
+
+	BitSet256 operator| (const BitSet256& other) const
+	{
+		BitSet256 result(Uninitialised);
+#if defined(BITSET256_SSE2)
+		for (int i = 0; i < 2; i++) { result.Store(i, _mm_or_si128(Load(i), other.Load(i))); }
+#else
+		for (int i = 0; i < 4; i++) { result.m_words[i] = m_words[i] | other.m_words[i]; }
+#endif
+		return result;
+	}
+
+	BitSet256 operator^ (const BitSet256& other) const
+	{
+		BitSet256 result(Uninitialised);
+#if defined(BITSET256_SSE2)
+		for (int i = 0; i < 2; i++) { result.Store(i, _mm_xor_si128(Load(i), other.Load(i))); }
+#else
+		for (int i = 0; i < 4; i++) { result.m_words[i] = m_words[i] ^ other.m_words[i]; }
+#endif
+		return result;
+	}
+
+	bool operator== (const BitSet256& other) const { return memcmp(m_words, other.m_words, sizeof(m_words)) == 0; }
+	bool operator!= (const BitSet256& other) const { return !(*this == other); }
+
+	/* Calls onBit with the index of every set bit, in increasing order */
+	template <typename F>
+	void ForEach(F onBit) const
+	{
+		for (unsigned i = 0; i < 4; i++)
+		{
+			uint64_t word = m_words[i];
+			while (word != 0)
+			{
+				onBit((i << 6) + CountTrailingZeros(word));
+				word &= word - 1;
+			}
+		}
+	}
+
+	uint64_t Word(unsigned nIndex) const { return m_words[nIndex]; }
+
+	static unsigned CountTrailingZeros(uint64_t nValue)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, nValue);
+		return (unsigned)(index);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		if (_BitScanForward(&index, (unsigned long)(nValue))) { return (unsigned)(index); }
+		_BitScanForward(&index, (unsigned long)(nValue >> 32));
+		return (unsigned)(index) + 32;
+#else
+		return (unsigned)(__builtin_ctzll(nValue));
+#endif
+	}
+
+private:
+
+	enum eUninitialised { Uninitialised };
+	BitSet256(eUninitialised) { }
+
+#if defined(BITSET256_SSE2)
+	__m128i Load(int nHalf) const { return _mm_load_si128(reinterpret_cast<const __m128i*>(m_words) + nHalf); }
+	void Store(int nHalf, __m128i value) { _mm_store_si128(reinterpret_cast<__m128i*>(m_words) + nHalf, value); }
+#endif
+
+	alignas(16) uint64_t m_words[4];
+
+}; // < end class.
+
+#endif // _BITSET256_HPP_
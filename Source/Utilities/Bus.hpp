@@ -0,0 +1,128 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: Bus.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for Bus utility.
+                 The Bus class is a statically typed
+                 event bus for events known at compile
+                 time. Every event type gets its own
+                 listener list, resolved by the compiler,
+                 so publishing skips the factory, the
+                 ObjectType() lookup and the EventManager's
+                 listener map entirely.
+
+    Functions: 1. template <void(*Function)(E&)>
+                  static bool Subscribe(void);
+
+               2. template <class C, void(C::*Function)(E&)>
+                  static bool Subscribe(C* instance);
+
+               3. template <void(*Function)(E&)>
+                  static bool Unsubscribe(void);
+
+               4. template <class C, void(C::*Function)(E&)>
+                  static bool Unsubscribe(C* instance);
+
+               5. static void Publish(E& event);
+
+    Example:
+
+        Bus<Event_KeyDown>::Subscribe<StateManager, &StateManager::OnKeyDown>(this);
+
+        Bus<Event_KeyDown>::Publish(keyDownEvent);
+
+---------------------------------------------------------*/
+
+#ifndef _BUS_HPP_
+	#define _BUS_HPP_
+
+#pragma once
+#include "Delegate.hpp"
+
+#include <cstddef>
+
+template <typename E>
+class Bus
+{
+public:
+	typedef Delegate<void(E&)> Listener;
+
+	/* Subscribes a free-function */
+	template <void(*Function)(E&)>
+	static bool Subscribe(void)
+    {
+		Listener listener;
+		listener.template Bind<Function>();
+
+		return s_listeners.Add(listener);
+	}
+
+	/* Subscribes a class-method */
+	template <class C, void(C::*Function)(E&)>
+	static bool Subscribe(C* instance)
+    {
+		Listener listener;
+		listener.template Bind<C, Function>(instance);
+
+		return s_listeners.Add(listener);
+	}
+
+	/* Subscribes an already bound delegate, such as a lambda */
+	static bool Subscribe(const Listener& listener)
+    {
+		return s_listeners.Add(listener);
+	}
+
+	template <void(*Function)(E&)>
+	static bool Unsubscribe(void)
+    {
+		Listener listener;
+		listener.template Bind<Function>();
+
+		return s_listeners.Remove(listener);
+	}
+
+	template <class C, void(C::*Function)(E&)>
+	static bool Unsubscribe(C* instance)
+    {
+		Listener listener;
+		listener.template Bind<C, Function>(instance);
+
+		return s_listeners.Remove(listener);
+	}
+
+	static bool Unsubscribe(const Listener& listener)
+    {
+		return s_listeners.Remove(listener);
+	}
+
+	/* Calls every listener of this event type, immediately, in the order they
+	   subscribed */
+	static inline void Publish(E& event)
+    {
+		s_listeners.Invoke(event);
+	}
+
+	static size_t Count(void)
+    {
+		return s_listeners.Size();
+	}
+
+private:
+	Bus(void);
+
+	static MulticastDelegate<void(E&)> s_listeners;
+
+}; // end class.
+
+template <typename E>
+MulticastDelegate<void(E&)> Bus<E>::s_listeners;
+
+#endif // _BUS_HPP_
@@ -0,0 +1,75 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: Clock.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for Clock utility.
+                 The Clock class abstracts the source of
+                 application time so that time-driven
+                 systems can be stepped deterministically.
+
+    Functions: 1. virtual uint64_t Millis(void);
+
+    Example:
+
+        ManualClock clock;
+        EventManager eventManager(&clock);
+
+        clock.Advance(250);
+        eventManager.Update();
+
+---------------------------------------------------------*/
+
+#ifndef _CLOCK_HPP_
+	#define _CLOCK_HPP_
+
+#pragma once
+#include "Leadwerks.h"
+
+#include <cstdint>
+
+class Clock
+{
+public:
+
+	virtual ~Clock(void) { }
+
+	virtual uint64_t Millis(void) = 0;		// < Gets the current time, in milliseconds.
+
+}; // < end class.
+
+// < A Clock driven by the Leadwerks application timer. It follows the timer's
+// * pausing, so scheduled work stops while the application is paused.
+class LeadwerksClock : public Clock
+{
+public:
+
+	uint64_t Millis(void) { return (uint64_t)(Leadwerks::Time::GetCurrent()); }
+
+}; // < end class.
+
+// < A Clock that only moves when told to.
+class ManualClock : public Clock
+{
+public:
+
+	ManualClock(uint64_t nStart = 0) : m_nNow(nStart) { }
+
+	uint64_t Millis(void) { return m_nNow; }
+
+	void Set(uint64_t nNow) { m_nNow = nNow; }
+	void Advance(uint64_t nMillis) { m_nNow += nMillis; }
+
+private:
+
+	uint64_t m_nNow;
+
+}; // < end class.
+
+#endif // _CLOCK_HPP_
@@ -1,48 +1,147 @@
 /*-------------------------------------------------------
                     <copyright>
-    
+
     File: Container.hpp
     Language: C++
-    
+
     (C) Copyright Eden Softworks
-    
+
     Author: Joshua Allen
     E-Mail: Joshua(AT)EdenSoftworks(DOT)net
-    
+
     Description: Header file for Container utility.
                  This file contains the source for a
                  very simple and lightweight Dependency
-                 Injection service.
-    
+                 Injection service. Components are stored
+                 by a per-type index, so resolving one is
+                 an array load rather than a lookup.
+                 Services may instead be declared, along
+                 with what they depend on, and are then
+                 created by the StartupScheduler or, if
+                 lazy, the first time they are resolved.
+
     Functions: 1. template <typename I, class C>
                   I* Register(C* pInstance);
-                  
-               2. template <typename I>
-                  I* Resolve(void);
-                  
+
+               2. template <typename I, typename... Deps, typename F>
+                  void Declare(unsigned nFlags, F create);
+
                3. template <typename I>
-                  bool TryResolve(I* value);                     
+                  I* Resolve(void);
+
+               4. template <typename I>
+                  I* TryResolve(void);
+
+               5. template <typename I>
+                  bool TryResolve(I*& pValue);
+
+               6. template <typename I>
+                  I* Peek(void);
+
+    Example:
+
+        // < InputManager needs the window, the context and the event manager,
+        // * and must be created on the main thread.
+        pContainer->Declare<InputManager, WindowHandle, ContextHandle, EventManager>(SERVICE_MAIN_THREAD,
+            [](Container& container) {
+                return new InputManager(...);
+            });
+
+        // < Systems that resolve every frame can keep a handle instead.
+        Resolved<InputManager> inputMgr(pContainer);
+
+        if (inputMgr) { inputMgr->Update(dt); }
 
 ---------------------------------------------------------*/
 
 #ifndef _CONTAINER_HPP_
     #define _CONTAINER_HPP_
-    
+
 #pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
 #include <exception>
-#include <map>
-#include <string>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 class Container_Resolve_Exception : public std::exception
 {
+public:
+	virtual const char* what() const throw() { return err(); }
 	virtual const char* err() const throw() { return "Failed to resolve dependency."; }
 };
 
-class Container 
-{    
-	typedef void* InstPtr;
-	typedef std::string ClassType;
-	typedef std::map<ClassType, std::pair<ClassType, const InstPtr>> ComponentMap;
+// < How a declared service is created.
+enum eServiceFlags
+{
+	SERVICE_ANY_THREAD      = 0,            // < May be created on a worker thread, alongside other services.
+	SERVICE_MAIN_THREAD     = 1 << 0,       // < Must be created on the thread that runs the StartupScheduler.
+	SERVICE_LAZY            = 1 << 1        // < Not created at startup, but the first time it is resolved.
+};
+
+// < Hands out a small, dense index per type, in the order the types are
+// * first used. The index is fixed for the life of the process, so it can
+// * be used to index straight into a Container's storage.
+class ContainerTypeIndex
+{
+public:
+
+	template <typename T>
+	static size_t Of(void)
+	{
+		static const size_t index = Next();
+		return index;
+	}
+
+private:
+
+	static size_t Next(void)
+	{
+		static std::atomic<size_t> next(0);
+		return next.fetch_add(1, std::memory_order_relaxed);
+	}
+
+}; // < end class.
+
+class Container
+{
+	friend class StartupScheduler;
+
+	// < A registered or declared component. The interface pointer is what
+	// * Resolve hands out; the instance pointer is what gets deleted, as its
+	// * real class. A declared component has a create function until it has
+	// * been created.
+	struct Component
+	{
+		std::atomic<void*>                          pInterface;
+		void*                                       pInstance;
+		void                                        (*pfnDelete)(void*);
+
+		std::function<void*(Container&, Component&)> create;
+		std::vector<size_t>                         dependencies;   // < Type indices this component resolves when created.
+		unsigned                                    nFlags;
+		const char*                                 cName;
+
+		Component(void) : pInterface(nullptr), pInstance(nullptr), pfnDelete(nullptr), nFlags(0), cName(nullptr) { }
+		Component(const Component& other) : pInterface(other.pInterface.load()) { Assign(other); }
+		Component& operator=(const Component& other) { pInterface.store(other.pInterface.load()); Assign(other); return *this; }
+
+		bool IsDeclared(void) const { return static_cast<bool>(create); }
+		bool IsCreated(void) const { return pInterface.load(std::memory_order_acquire) != nullptr; }
+
+	private:
+		void Assign(const Component& other)
+		{
+			pInstance = other.pInstance; pfnDelete = other.pfnDelete; create = other.create;
+			dependencies = other.dependencies; nFlags = other.nFlags; cName = other.cName;
+		}
+	};
+
+	typedef std::vector<Component> ComponentList;
 
 public:
 
@@ -50,49 +149,82 @@ public:
 	~Container(void) { Dispose(); }
 
     template <typename I, class C>
-    I* Register(C* pInstance);    
+    I* Register(C* pInstance);
+
+	// < Register and Declare are main-thread only, and not while the
+	// * StartupScheduler is running.
+    template <typename I, typename... Deps, typename F>
+    void Declare(unsigned nFlags, F create);
 
     template <typename I>
     I* Resolve(void);
-    
+
     template <typename I>
-    bool TryResolve(I& value);
+    I* TryResolve(void);
+
+    template <typename I>
+    bool TryResolve(I*& pValue);
+
+	// < Returns the component only if it already exists; never creates it.
+	template <typename I>
+	I* Peek(void);
+
+	template <typename I>
+	bool IsRegistered(void);
 
 protected:
 
-    template <typename I>
-    ComponentMap::iterator FetchInternal(void);
-    
 	// < Destroys and removes all registered components from the component
-	// * collection.
-	void Container::Dispose(void)
+	// * collection, last created first, so a component is destroyed
+	// * before anything it was built from.
+	void Dispose(void)
 	{
-		// < We make sure to remove components starting at the end
-		// * of the collection, working our way to the front. T1
-		// * allows the preservation of internal class define
-		// * should a resolution call be made before the a
-		// * is terminated.
-		auto iter = m_components.rend();
-		while (iter != m_components.rbegin()) {
-			iter--;
-
-			auto it = iter->second.second;
-
-			if (it) {
-				delete (it);
-				it = NULL;
-			}
-
-			//it = ComponentMap::reverse_iterator(m_components.erase(iter.base()) - 1);
+		while (!m_order.empty()) {
+
+			Component& comp = m_components[m_order.back()];
+			m_order.pop_back();
+
+			if (comp.pInstance != nullptr) { comp.pfnDelete(comp.pInstance); }
+			comp.pInterface.store(nullptr);
+			comp.pInstance = nullptr;
 		}
 
 		m_components.clear();
 
 	} // < ---
 
+	// < Runs a declared component's create function, recording it for
+	// * disposal. Returns the interface, or nullptr if creation failed.
+	void* Create(size_t index)
+	{
+		Component& comp = m_components[index];
+
+		void* pInterface = comp.create(*this, comp);
+		if (pInterface == nullptr) { return nullptr; }
+
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
+		m_order.push_back(index);
+
+		return pInterface;
+
+	} // < ---
+
 private:
 
-	ComponentMap m_components;     // < The collection of registered components.    	
+	template <class C>
+	static void DeleteStub(void* pInstance) { delete static_cast<C*>(pInstance); }
+
+	Component& Slot(size_t index)
+	{
+		if (index >= m_components.size()) { m_components.resize(index + 1); }
+		return m_components[index];
+	}
+
+	void* CreateLazy(size_t index);
+
+	ComponentList m_components;     // < The collection of registered components, by type index.
+	std::vector<size_t> m_order;    // < The type index of each component, in creation order.
+	std::recursive_mutex m_mutex;   // < Guards m_order and lazy creation; a lazy service may resolve another.
 
 }; // < end class.
 
@@ -103,62 +235,151 @@ private:
 // * instance will be returned.
 template <typename I, class C>
 I* Container::Register(C* pInstance)
-{    
-    std::string interfaceType = I::ClassType();
-    std::string classType = C::ClassType();
+{
+    Component& comp = Slot(ContainerTypeIndex::Of<I>());
+    if (comp.IsCreated()) { return static_cast<I*>(comp.pInterface.load()); }
+
+    comp.pInstance = pInstance;
+    comp.pfnDelete = &Container::DeleteStub<C>;
+    comp.pInterface.store(static_cast<I*>(pInstance));
+
+    m_order.push_back(ContainerTypeIndex::Of<I>());
+
+    return static_cast<I*>(comp.pInterface.load());
+
+} // < ---
+
+// < Declares a service, the types it resolves while being created and
+// * how it is created. F is called as F(Container&) and returns the new
+// * instance, or nullptr on failure. Declaring an existing component
+// * does nothing.
+template <typename I, typename... Deps, typename F>
+void Container::Declare(unsigned nFlags, F create)
+{
+    typedef typename std::remove_pointer<decltype(create(std::declval<Container&>()))>::type C;
+
+    // < Every slot the service touches exists before the scheduler runs, so
+    // * the collection never grows under a worker thread.
+    std::vector<size_t> dependencies = { ContainerTypeIndex::Of<Deps>()... };
+    for (size_t dependency : dependencies) { Slot(dependency); }
+
+    Component& comp = Slot(ContainerTypeIndex::Of<I>());
+    if (comp.IsCreated() || comp.IsDeclared()) { return; }
 
-    auto key = interfaceType;
-    auto entry = std::make_pair(classType, (void*)(pInstance));
+    comp.dependencies = dependencies;
+    comp.nFlags = nFlags;
+    comp.cName = I::ClassType();
+    comp.create = [create](Container& container, Component& self) -> void* {
+        C* pInstance = create(container);
+        if (pInstance == nullptr) { return nullptr; }
+
+        self.pInstance = pInstance;
+        self.pfnDelete = &Container::DeleteStub<C>;
+        self.pInterface.store(static_cast<I*>(pInstance), std::memory_order_release);
+
+        return self.pInterface.load(std::memory_order_relaxed);
+    };
 
-    m_components.insert(std::make_pair(key, entry));
-    
-    return Resolve<I>();
-    
 } // < ---
 
 // < Attempts to fetch a registered component from the components
 // * collection. If found a pointer to the component is returned
-// * else, a cassert exception is thrown.
+// * else, a Container_Resolve_Exception is thrown.
 template <typename I>
 I* Container::Resolve(void)
 {
-    auto comp = FetchInternal<I>();
-    if (comp == m_components.end()) { throw Container_Resolve_Exception();}
-    
-    return static_cast<I*>(comp->second.second);
-    
+    I* pValue = TryResolve<I>();
+    if (pValue == nullptr) { throw Container_Resolve_Exception(); }
+
+    return pValue;
+
 } // < ---
 
-// < Attempts to fetch a registered component from the components 
-// * collection. If found, the given value pointer is pointer
-// * and a value of true is returned else, value will else
-// * nullptr and a value of false is returned.
+// < Attempts to fetch a registered component from the components
+// * collection, creating a lazy one on first use. If found a pointer
+// * to the component is returned else, nullptr is returned. Never throws.
 template <typename I>
-bool Container::TryResolve(I& value)
-{    
-    try 
-    {
-        *value = Resolve<I>();
-    }
-    catch(...) 
-    {
-        value = nullptr;
-        return false;
-    }
-    
-    return true;
-    
-}
+I* Container::TryResolve(void)
+{
+    size_t index = ContainerTypeIndex::Of<I>();
+    if (index >= m_components.size()) { return nullptr; }
+
+    void* pValue = m_components[index].pInterface.load(std::memory_order_acquire);
+    if (pValue == nullptr && m_components[index].IsDeclared()) { pValue = CreateLazy(index); }
+
+    return static_cast<I*>(pValue);
+
+} // < ---
+
+// < As above, storing the component in the given pointer and
+// * returning whether it was found.
+template <typename I>
+bool Container::TryResolve(I*& pValue)
+{
+    pValue = TryResolve<I>();
+    return pValue != nullptr;
+
+} // < ---
+
+template <typename I>
+I* Container::Peek(void)
+{
+    size_t index = ContainerTypeIndex::Of<I>();
+    if (index >= m_components.size()) { return nullptr; }
+
+    return static_cast<I*>(m_components[index].pInterface.load(std::memory_order_acquire));
+
+} // < ---
 
-// < Attempts to fetch a registered component from the components
-// * collection. If found, an iterator to the component is
-// * returned else, an iterator to m_components.end() is returned.
 template <typename I>
-Container::ComponentMap::iterator Container::FetchInternal(void) 
+bool Container::IsRegistered(void)
 {
-    std::string key = I::ClassType();
-    return m_components.find(key);
-    
+    size_t index = ContainerTypeIndex::Of<I>();
+    return index < m_components.size() && (m_components[index].IsCreated() || m_components[index].IsDeclared());
+
+} // < ---
+
+inline void* Container::CreateLazy(size_t index)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    // < Another thread may have created it while we waited.
+    Component& comp = m_components[index];
+    if (comp.IsCreated()) { return comp.pInterface.load(std::memory_order_acquire); }
+
+    return Create(index);
+
 } // < ---
 
-#endif _CONTAINER_HPP_
\ No newline at end of file
+// < Caches a resolved component for systems that need it every frame. The
+// * component is resolved on first use, and again on later uses until it
+// * has been registered; the cached pointer lives as long as the Container.
+template <typename T>
+class Resolved
+{
+public:
+
+	Resolved(void) : m_pContainer(nullptr), m_pValue(nullptr) { }
+	explicit Resolved(Container* pContainer) : m_pContainer(pContainer), m_pValue(nullptr) { }
+
+	void Bind(Container* pContainer) { m_pContainer = pContainer; m_pValue = nullptr; }
+	void Reset(void) { m_pValue = nullptr; }
+
+	T* Get(void)
+	{
+		if (m_pValue == nullptr && m_pContainer != nullptr) { m_pValue = m_pContainer->TryResolve<T>(); }
+		return m_pValue;
+	}
+
+	T* operator-> (void) { return Get(); }
+	T& operator* (void) { return *Get(); }
+	explicit operator bool(void) { return Get() != nullptr; }
+
+private:
+
+	Container*  m_pContainer;
+	T*          m_pValue;
+
+}; // < end class.
+
+#endif _CONTAINER_HPP_
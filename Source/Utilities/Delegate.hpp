@@ -1,27 +1,49 @@
 /*-------------------------------------------------------
                     <copyright>
-    
+
     File: Delegate.hpp
     Language: C++
-    
+
     (C) Copyright Eden Softworks
-    
+
     Author: Joshua Allen
     E-Mail: Joshua(AT)EdenSoftworks(DOT)net
-    
+
     Description: Header file for Delegate utility.
                  The Delegate class provieds an easy an
                  lighteright implementation for the
-                 registration of functions and member 
-                 function for callback.
-    
-    Functions: 1. template <void(*function)(*)>
-                  void Bind(void);
-                  
-               2. template <class C, void(C::*Function)(T)>
+                 registration of functions, member
+                 functions and lambdas for callback.
+                 Lambda captures are stored inline, so
+                 binding never allocates.
+                 The MulticastDelegate class holds any
+                 number of delegates in a contiguous array
+                 and invokes them in order.
+
+    Functions: 1. template <R(*Function)(Args...)>
                   void Bind(void);
-                  
-               3. void Invoke(T ARG0);
+
+               2. template <class C, R(C::*Function)(Args...)>
+                  void Bind(C* instance);
+
+               3. template <typename F>
+                  void Bind(F functor);
+
+               4. R Invoke(Args... args) const;
+
+               5. const Stub Target(void) const;
+
+               6. bool MulticastDelegate::Add(const Delegate& delegate);
+
+               7. bool MulticastDelegate::Remove(const Delegate& delegate);
+
+               8. void MulticastDelegate::Invoke(Args... args);
+
+    Example:
+
+        Delegate<void(int)> onScore;
+        onScore.Bind([this](int points) { m_nScore += points; });
+        onScore.Invoke(10);
 
 ---------------------------------------------------------*/
 
@@ -30,59 +52,118 @@
 
 #pragma once
 #include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+template <typename Signature>
+class Delegate;
 
-template <typename T>
-class Delegate
+template <typename R, typename... Args>
+class Delegate<R(Args...)>
 {
-	typedef void* InstancePtr;
-	typedef void(*InternalFunction)(InstancePtr, T);
-	typedef std::pair<InstancePtr, InternalFunction> Stub;
+	/* Room for a bound instance, or for the captures of a small lambda */
+	enum { STORAGE_SIZE = 4 * sizeof(void*) };
+
+	typedef typename std::aligned_storage<STORAGE_SIZE, alignof(void*)>::type Storage;
+	typedef R(*InternalFunction)(const Storage&, Args...);
 
 	/* Turns a free function into our internal function stub */
-	template <void(*Function)(T)>
-	static inline void FunctionStub(InstancePtr, T ARG0)
+	template <R(*Function)(Args...)>
+	static inline R FunctionStub(const Storage&, Args... args)
     {
-		return (Function)(ARG0);
+		return (Function)(std::forward<Args>(args)...);
 	}
 
 	/* Turns a member function into our internal function stub */
-	template <class C, void(C::*Function)(T)>
-	static inline void ClassMethodStub(InstancePtr instance, T ARG0)
+	template <class C, R(C::*Function)(Args...)>
+	static inline R ClassMethodStub(const Storage& storage, Args... args)
     {
-		return (static_cast<C*>(instance)->*Function)(ARG0);
+		C* instance = *reinterpret_cast<C* const*>(&storage);
+		return (instance->*Function)(std::forward<Args>(args)...);
+	}
+
+	/* Turns a functor stored inline into our internal function stub */
+	template <typename F>
+	static inline R FunctorStub(const Storage& storage, Args... args)
+    {
+		F& functor = *const_cast<F*>(reinterpret_cast<const F*>(&storage));
+		return functor(std::forward<Args>(args)...);
 	}
 
 public:
-	Delegate(void) : m_stub(nullptr, nullptr) { };
+	typedef std::pair<const void*, const void*> Stub;
+
+	Delegate(void) : m_pFunction(nullptr) { memset(&m_storage, 0, sizeof(m_storage)); }
 
 	/* Binds a free-function */
-	template <void(*Function)(T)>
+	template <R(*Function)(Args...)>
 	void Bind(void)
     {
-		this->m_stub.first = nullptr;
-		this->m_stub.second = &FunctionStub < Function > ;
+		memset(&this->m_storage, 0, sizeof(this->m_storage));
+		this->m_pFunction = &FunctionStub < Function > ;
 	}
 
 	/* Binds a class-method */
-	template <class C, void(C::*Function)(T)>
+	template <class C, R(C::*Function)(Args...)>
 	void Bind(C* instance)
     {
-		this->m_stub.first = instance;
-		this->m_stub.second = &ClassMethodStub < C, Function > ;
+		memset(&this->m_storage, 0, sizeof(this->m_storage));
+		*reinterpret_cast<C**>(&this->m_storage) = instance;
+		this->m_pFunction = &ClassMethodStub < C, Function > ;
+	}
+
+	/* Binds a lambda or other functor. Its captures are copied into the
+	   delegate, so they must be small and trivially copyable (pointers,
+	   references, plain values). */
+	template <typename F>
+	void Bind(F functor)
+    {
+		static_assert(sizeof(F) <= STORAGE_SIZE, "Functor captures too much state to be stored inline.");
+		static_assert(alignof(F) <= alignof(Storage), "Functor is over-aligned for inline storage.");
+		static_assert(std::is_trivially_copyable<F>::value, "Functor captures must be trivially copyable.");
+
+		memset(&this->m_storage, 0, sizeof(this->m_storage));
+		new (&this->m_storage) F(functor);
+		this->m_pFunction = &FunctorStub < F > ;
 	}
 
 	/* Invokes the delegate */
-	void Invoke(T ARG0) const
+	R Invoke(Args... args) const
+    {
+		assert(m_pFunction != nullptr);	 // Cannot invoke unbound delegate. Call Bind() first.
+		return this->m_pFunction(m_storage, std::forward<Args>(args)...);
+	}
+
+	R operator() (Args... args) const
     {
-		assert(m_stub.second != nullptr);	 // Cannot invoke unbound delegate. Call Bind() first.
-		return this->m_stub.second(m_stub.first, ARG0);
+		return Invoke(std::forward<Args>(args)...);
 	}
 
-	bool operator== (const Delegate<T>& other)
+	bool IsBound(void) const
     {
-		if (this->m_stub.first != other.m_stub.first ||
-			this->m_stub.second != other.m_stub.second)
+		return this->m_pFunction != nullptr;
+	}
+
+	void Unbind(void)
+    {
+		memset(&this->m_storage, 0, sizeof(this->m_storage));
+		this->m_pFunction = nullptr;
+	}
+
+	/* Returns the bound instance (or first word of captures) and the function
+	   stub, identifying this delegate */
+	const Stub Target(void) const
+    {
+		return Stub(*reinterpret_cast<const void* const*>(&this->m_storage), reinterpret_cast<const void*>(this->m_pFunction));
+	}
+
+	bool operator== (const Delegate& other) const
+    {
+		if (this->m_pFunction != other.m_pFunction ||
+			memcmp(&this->m_storage, &other.m_storage, sizeof(Storage)) != 0)
             {
 			return false;
 		}
@@ -90,9 +171,119 @@ public:
 		return true;
 	}
 
+	bool operator!= (const Delegate& other) const
+    {
+		return !(*this == other);
+	}
+
+private:
+	InternalFunction m_pFunction;
+	Storage m_storage;
+
+}; // end class.
+
+template <typename Signature>
+class MulticastDelegate;
+
+template <typename R, typename... Args>
+class MulticastDelegate<R(Args...)>
+{
+public:
+	typedef Delegate<R(Args...)> DelegateType;
+
+	MulticastDelegate(void) : m_nInvokeDepth(0), m_bNeedsCompact(false) { }
+
+	/* Adds the given delegate. Returns false if it was already added */
+	bool Add(const DelegateType& delegate)
+    {
+		for (size_t i = 0; i < m_delegates.size(); i++)
+            {
+			if (m_delegates[i] == delegate) { return false; }
+		}
+
+		m_delegates.push_back(delegate);
+		return true;
+	}
+
+	/* Removes the given delegate. Delegates removed while invoking are only
+	   unbound, and compacted away once invocation completes */
+	bool Remove(const DelegateType& delegate)
+    {
+		for (size_t i = 0; i < m_delegates.size(); i++)
+            {
+			if (m_delegates[i] != delegate) { continue; }
+
+			if (m_nInvokeDepth > 0)
+                {
+				m_delegates[i].Unbind();
+				m_bNeedsCompact = true;
+			}
+			else
+                {
+				m_delegates.erase(m_delegates.begin() + i);
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	/* Invokes every bound delegate, in the order they were added */
+	void Invoke(Args... args)
+    {
+		m_nInvokeDepth += 1;
+
+		for (size_t i = 0; i < m_delegates.size(); i++)
+            {
+			// < Invoke a copy; a listener may add delegates and grow the array.
+			DelegateType delegate = m_delegates[i];
+			if (delegate.IsBound()) { delegate.Invoke(args...); }
+		}
+
+		m_nInvokeDepth -= 1;
+		if (m_nInvokeDepth == 0 && m_bNeedsCompact) { Compact(); }
+	}
+
+	void operator() (Args... args)
+    {
+		Invoke(args...);
+	}
+
+	/* Allows callers to walk the delegates themselves; use BeginInvoke and
+	   EndInvoke around the walk so removals are deferred */
+	void BeginInvoke(void) { m_nInvokeDepth += 1; }
+	void EndInvoke(void)
+    {
+		m_nInvokeDepth -= 1;
+		if (m_nInvokeDepth == 0 && m_bNeedsCompact) { Compact(); }
+	}
+
+	const DelegateType& operator[] (size_t index) const { return m_delegates[index]; }
+
+	size_t Size(void) const { return m_delegates.size(); }
+	bool empty(void) const { return m_delegates.empty(); }
+	bool IsInvoking(void) const { return m_nInvokeDepth > 0; }
+	void Clear(void) { m_delegates.clear(); }
+
 private:
-	Stub m_stub;
+
+	void Compact(void)
+    {
+		size_t write = 0;
+		for (size_t read = 0; read < m_delegates.size(); read++)
+            {
+			if (m_delegates[read].IsBound()) { m_delegates[write++] = m_delegates[read]; }
+		}
+
+		m_delegates.resize(write);
+		m_bNeedsCompact = false;
+	}
+
+	std::vector<DelegateType> m_delegates;
+	int m_nInvokeDepth;
+	bool m_bNeedsCompact;
 
 }; // end class.
 
-#endif // _DELEGATE_HPP_
\ No newline at end of file
+#endif // _DELEGATE_HPP_
@@ -5,6 +5,9 @@
 #include "Leadwerks.h"
 #include "Factory.hpp"
 #include "ParameterMap.hpp"
+#include "StringId.hpp"
+
+#include <cstdint>
 
 /* MACROS */
 #define REGISTER_EVENT(eventClass)	{ gEventFactory.Register(eventClass); }
@@ -12,21 +15,39 @@
 
 // -----
 
-typedef const char* EventType;
+typedef StringId    EventType;
+typedef uint64_t    EventTarget;
+
+/* The target of an event that is broadcast to every listener of its type. */
+#define EVENT_TARGET_NONE ((EventTarget)(~0ull))
+
+class EventManager;
 
 /* Base Event */
 class BaseEventData : public ParameterMap {
+	friend class EventManager;
+
 public:
 	BaseEventData(const float nTimeStamp = 0.0f)
-		: m_nTimeStamp(nTimeStamp) { }
+		: m_nTimeStamp(nTimeStamp), m_nQueuedMicros(0), m_nTarget(EVENT_TARGET_NONE) { }
 	
 	virtual const char*	ObjectType() = 0;
+	virtual StringId	ObjectId() = 0;
 	const float	TimeStamp() { return m_nTimeStamp; }
+	const uint64_t QueuedAt() { return m_nQueuedMicros; }
+
+	/* Routes the event to the listeners of a single entity or channel. Targeted
+	 * - events reach that target's listeners, plus any listener of the whole type. */
+	void SetTarget(EventTarget nTarget) { m_nTarget = nTarget; }
+	const EventTarget Target() { return m_nTarget; }
+	const bool IsTargeted() { return m_nTarget != EVENT_TARGET_NONE; }
 
 protected:
 
 private:
-	float	m_nTimeStamp; // The time the event was created.
+	float		m_nTimeStamp;		// The time the event was created.
+	uint64_t	m_nQueuedMicros;	// The time the event was last queued, set by the EventManager.
+	EventTarget	m_nTarget;			// The entity or channel the event is routed to, if any.
 
 }; // end class EventBase.
 
@@ -41,15 +62,11 @@ public:
 	}
 
 	Leadwerks::Vec3 MousePosition(void) { 
-		auto val = this->GetVec3("vMousePosition");
-		if (val != this->GetVec3Map().end()) { return val->second; }
-		else { return Leadwerks::Vec3(-1.0f, -1.0f, 0.0f); }
+		return this->GetVec3("vMousePosition", Leadwerks::Vec3(-1.0f, -1.0f, 0.0f));
 	}
 
 	int MouseButton(void) { 
-		auto val = this->GetInt("nMouseButton");
-		if (val != this->GetIntMap().end()) { return val->second; }
-		else { return -1; }
+		return this->GetInt("nMouseButton", -1);
 	}
 };
 
@@ -64,15 +81,11 @@ public:
 	}
 
 	Leadwerks::Vec3 MousePosition(void) {
-		auto val = this->GetVec3("vMousePosition");
-		if (val != this->GetVec3Map().end()) { return val->second; }
-		else { return Leadwerks::Vec3(-1.0f, -1.0f, 0.0f); }
+		return this->GetVec3("vMousePosition", Leadwerks::Vec3(-1.0f, -1.0f, 0.0f));
 	}
 
 	int MouseButton(void) {
-		auto val = this->GetInt("nMouseButton");
-		if (val != this->GetIntMap().end()) { return val->second; }
-		else { return -1; }
+		return this->GetInt("nMouseButton", -1);
 	}
 };
 
@@ -87,15 +100,35 @@ public:
 	}
 
 	Leadwerks::Vec3 MousePosition(void) {
-		auto val = this->GetVec3("vMousePosition");
-		if (val != this->GetVec3Map().end()) { return val->second; }
-		else { return Leadwerks::Vec3(-1.0f, -1.0f, 0.0f); }
+		return this->GetVec3("vMousePosition", Leadwerks::Vec3(-1.0f, -1.0f, 0.0f));
 	}
 
 	int MouseButton(void) {
-		auto val = this->GetInt("nMouseButton");
-		if (val != this->GetIntMap().end()) { return val->second; }
-		else { return -1; }
+		return this->GetInt("nMouseButton", -1);
+	}
+};
+
+/* Mouse Move Event */
+class Event_MouseMove : public BaseEventData {
+	CLASS_TYPE(Event_MouseMove);
+
+public:
+	Event_MouseMove() : BaseEventData() {
+		Set("vMousePosition", Leadwerks::Vec3(-1.0f, -1.0f, 0.0f))->
+			Set("fDeltaX", 0.0f)->
+			Set("fDeltaY", 0.0f);
+	}
+
+	Leadwerks::Vec3 MousePosition(void) {
+		return this->GetVec3("vMousePosition", Leadwerks::Vec3(-1.0f, -1.0f, 0.0f));
+	}
+
+	float DeltaX(void) {
+		return this->GetFloat("fDeltaX", 0.0f);
+	}
+
+	float DeltaY(void) {
+		return this->GetFloat("fDeltaY", 0.0f);
 	}
 };
 
@@ -109,9 +142,7 @@ public:
 	}
 
 	int Key(void) {
-		auto val = this->GetInt("nKey");
-		if (val != this->GetIntMap().end()) { return val->second; }
-		else { return -1; }
+		return this->GetInt("nKey", -1);
 	}
 };
 
@@ -125,9 +156,7 @@ public:
 	}
 
 	int Key(void) {
-		auto val = this->GetInt("nKey");
-		if (val != this->GetIntMap().end()) { return val->second; }
-		else { return -1; }
+		return this->GetInt("nKey", -1);
 	}
 };
 
@@ -141,9 +170,7 @@ public:
 	}
 
 	int Key(void) {
-		auto val = this->GetInt("nKey");
-		if (val != this->GetIntMap().end()) { return val->second; }
-		else { return -1; }
+		return this->GetInt("nKey", -1);
 	}
 };
 
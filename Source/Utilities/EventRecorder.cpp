@@ -0,0 +1,254 @@
+#pragma once
+#include "EventRecorder.hpp"
+
+#include <cstring>
+#include <iterator>
+
+enum eRecordTag { TAG_TYPE = 1, TAG_KEY = 2, TAG_EVENT = 3 };
+
+static const char		s_magic[4] = { 'L', 'W', 'E', 'V' };
+static const uint16_t	s_version = 3;
+
+// -----
+// EventRecorder
+// -----
+
+bool EventRecorder::Open(const std::string& path)
+{
+	Close();
+
+	m_out.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_out.is_open()) { return false; }
+
+	m_out.write(s_magic, sizeof(s_magic));
+	Write(s_version);
+
+	return true;
+}
+
+void EventRecorder::Close(void)
+{
+	if (m_out.is_open()) { m_out.close(); }
+
+	m_types.clear();
+	m_keys.clear();
+}
+
+void EventRecorder::Record(uint32_t nFrame, uint8_t nChannel, BaseEventData& event)
+{
+	if (!m_out.is_open()) { return; }
+
+	// < Names are written once, the first time they are seen; everything
+	// * after refers to them by id. Game-object pointers are not recorded.
+	uint16_t type = TypeId(event.ObjectType());
+
+	uint8_t count = 0;
+	for (size_t i = 0; i < event.Count(); i++)
+	{
+		if (event.TypeAt(i) == PARAMETER_DATA) { continue; }
+
+		KeyId(event.KeyAt(i));
+		count += 1;
+	}
+
+	Write((uint8_t)(TAG_EVENT));
+	Write(nFrame);
+	Write(type);
+	Write(nChannel);
+	Write(event.Target());
+	Write(count);
+
+	for (size_t i = 0; i < event.Count(); i++)
+	{
+		const ParameterMap::Parameter& parameter = event.At(i);
+		if (parameter.type == PARAMETER_DATA) { continue; }
+
+		Write(m_keys[parameter.nKey]);
+		Write((uint8_t)(parameter.type));
+
+		switch (parameter.type)
+		{
+		case PARAMETER_INT: Write((int32_t)(parameter.nInt)); break;
+		case PARAMETER_FLOAT: Write(parameter.fFloat); break;
+		case PARAMETER_VEC3: Write(parameter.vVec3[0]); Write(parameter.vVec3[1]); Write(parameter.vVec3[2]); break;
+		case PARAMETER_STRING:
+			{
+				const std::string& value = event.StringAt(i);
+				Write((uint16_t)(value.size()));
+				m_out.write(value.data(), value.size());
+			}
+			break;
+		default: break;
+		}
+	}
+}
+
+uint16_t EventRecorder::TypeId(const std::string& type)
+{
+	auto find = m_types.find(type);
+	if (find != m_types.end()) { return find->second; }
+
+	uint16_t id = (uint16_t)(m_types.size());
+	m_types[type] = id;
+	WriteName(TAG_TYPE, id, type);
+
+	return id;
+}
+
+uint16_t EventRecorder::KeyId(StringId key)
+{
+	auto find = m_keys.find(key.Id());
+	if (find != m_keys.end()) { return find->second; }
+
+	uint16_t id = (uint16_t)(m_keys.size());
+	m_keys[key.Id()] = id;
+	WriteName(TAG_KEY, id, key.c_str());
+
+	return id;
+}
+
+void EventRecorder::WriteName(uint8_t tag, uint16_t id, const std::string& name)
+{
+	Write(tag);
+	Write(id);
+	Write((uint8_t)(name.size()));
+	m_out.write(name.data(), name.size() & 0xff);
+}
+
+// -----
+// RecordedEvent
+// -----
+
+void RecordedEvent::Apply(BaseEventData& event) const
+{
+	event.SetTarget(nTarget);
+
+	for (size_t i = 0; i < params.Count(); i++)
+	{
+		const ParameterMap::Parameter& parameter = params.At(i);
+		StringId key = params.KeyAt(i);
+
+		switch (parameter.type)
+		{
+		case PARAMETER_INT: event.Set(key, parameter.nInt); break;
+		case PARAMETER_FLOAT: event.Set(key, parameter.fFloat); break;
+		case PARAMETER_VEC3: event.Set(key, Leadwerks::Vec3(parameter.vVec3[0], parameter.vVec3[1], parameter.vVec3[2])); break;
+		case PARAMETER_STRING: event.Set(key, params.StringAt(i)); break;
+		default: break;
+		}
+	}
+}
+
+// -----
+// EventPlayer
+// -----
+
+// < A bounds-checked cursor over the raw log.
+struct LogReader
+{
+	const std::vector<char>&	data;
+	size_t						nPos;
+	bool						bValid;
+
+	LogReader(const std::vector<char>& _data) : data(_data), nPos(0), bValid(true) { }
+
+	template <typename T> T Read(void)
+	{
+		T value = T();
+		if (nPos + sizeof(T) > data.size()) { bValid = false; return value; }
+
+		memcpy(&value, &data[nPos], sizeof(T));
+		nPos += sizeof(T);
+		return value;
+	}
+
+	std::string ReadString(size_t nLength)
+	{
+		if (nPos + nLength > data.size()) { bValid = false; return std::string(); }
+
+		std::string value(&data[nPos], nLength);
+		nPos += nLength;
+		return value;
+	}
+
+	bool AtEnd(void) const { return nPos >= data.size(); }
+};
+
+bool EventPlayer::Open(const std::string& path)
+{
+	Close();
+
+	std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+	if (!in.is_open()) { return false; }
+
+	std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	LogReader reader(data);
+	if (reader.ReadString(sizeof(s_magic)) != std::string(s_magic, sizeof(s_magic))) { return false; }
+	if (reader.Read<uint16_t>() != s_version) { return false; }
+
+	std::map<uint16_t, std::string> types;
+	std::map<uint16_t, StringId> keys;
+
+	while (reader.bValid && !reader.AtEnd())
+	{
+		uint8_t tag = reader.Read<uint8_t>();
+
+		if (tag == TAG_TYPE || tag == TAG_KEY)
+		{
+			uint16_t id = reader.Read<uint16_t>();
+			uint8_t length = reader.Read<uint8_t>();
+			std::string name = reader.ReadString(length);
+
+			if (tag == TAG_TYPE) { types[id] = name; }
+			else { keys[id] = StringId::Intern(name); }
+		}
+		else if (tag == TAG_EVENT)
+		{
+			RecordedEvent event;
+			event.handle = INVALID_FACTORY_HANDLE;
+			event.nFrame = reader.Read<uint32_t>();
+			event.type = types[reader.Read<uint16_t>()];
+			event.nChannel = reader.Read<uint8_t>();
+			event.nTarget = reader.Read<EventTarget>();
+
+			uint8_t count = reader.Read<uint8_t>();
+
+			for (uint8_t i = 0; i < count && reader.bValid; i++)
+			{
+				StringId key = keys[reader.Read<uint16_t>()];
+				uint8_t type = reader.Read<uint8_t>();
+
+				switch (type)
+				{
+				case PARAMETER_INT: event.params.Set(key, (int)(reader.Read<int32_t>())); break;
+				case PARAMETER_FLOAT: event.params.Set(key, reader.Read<float>()); break;
+				case PARAMETER_VEC3:
+					{
+						float x = reader.Read<float>();
+						float y = reader.Read<float>();
+						float z = reader.Read<float>();
+						event.params.Set(key, Leadwerks::Vec3(x, y, z));
+					}
+					break;
+				case PARAMETER_STRING:
+					{
+						uint16_t length = reader.Read<uint16_t>();
+						event.params.Set(key, reader.ReadString(length));
+					}
+					break;
+				default: reader.bValid = false; break;
+				}
+			}
+
+			if (reader.bValid) { m_events.push_back(event); }
+		}
+		else
+		{
+			// < Unknown record, the rest of the log cannot be trusted.
+			break;
+		}
+	}
+
+	return !m_events.empty();
+}
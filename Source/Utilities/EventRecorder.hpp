@@ -0,0 +1,143 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: EventRecorder.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for EventRecorder utility.
+                 The EventRecorder writes events, tagged
+                 with the frame they were dispatched on,
+                 to a compact binary log. The EventPlayer
+                 reads such a log back frame by frame.
+
+    Functions: 1. bool EventRecorder::Open(const std::string& path);
+
+               2. void EventRecorder::Record(uint32_t nFrame, uint8_t nChannel, BaseEventData& event);
+
+               3. bool EventPlayer::Open(const std::string& path);
+
+               4. template <typename F>
+                  void EventPlayer::Play(uint32_t nFrame, F onEvent);
+
+    Format:    "LWEV" u16 version, followed by records.
+               TYPE  (1): u16 id, u8 length, name.
+               KEY   (2): u16 id, u8 length, name.
+               EVENT (3): u32 frame, u16 type, u8 channel, u64 target,
+                          u8 count, then (u16 key, u8 type, value)
+                          per parameter.
+
+---------------------------------------------------------*/
+
+#ifndef _EVENT_RECORDER_HPP_
+	#define _EVENT_RECORDER_HPP_
+
+#pragma once
+#include "Leadwerks.h"
+#include "Event.hpp"
+#include "ParameterMap.hpp"
+#include "StringId.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class EventRecorder
+{
+public:
+
+	EventRecorder(void) { }
+	~EventRecorder(void) { Close(); }
+
+	bool                                        Open(const std::string& path);
+	void                                        Close(void);
+	bool                                        IsOpen(void) const { return m_out.is_open(); }
+
+	void                                        Record(uint32_t nFrame, uint8_t nChannel, BaseEventData& event);
+
+private:
+
+	uint16_t                                    TypeId(const std::string& type);
+	uint16_t                                    KeyId(StringId key);
+
+	void                                        WriteName(uint8_t tag, uint16_t id, const std::string& name);
+
+	template <typename T> void                  Write(const T& value) { m_out.write((const char*)(&value), sizeof(T)); }
+
+	std::ofstream                               m_out;
+	std::map<std::string, uint16_t>             m_types;
+	std::map<uint32_t, uint16_t>                m_keys;
+
+}; // < end class.
+
+/* A single event read back from a log. */
+struct RecordedEvent
+{
+	uint32_t                                            nFrame;
+	uint8_t                                             nChannel;
+	EventTarget                                         nTarget;
+	std::string                                         type;
+	FactoryHandle                                       handle;         // The event factory's handle for type, once resolved.
+
+	ParameterMap                                        params;
+
+	// < Copies the recorded parameters onto the given event.
+	void Apply(BaseEventData& event) const;
+
+}; // < end struct.
+
+class EventPlayer
+{
+public:
+
+	EventPlayer(void) : m_nCursor(0) { }
+
+	bool                                        Open(const std::string& path);
+	void                                        Close(void) { m_events.clear(); m_nCursor = 0; }
+
+	bool                                        IsOpen(void) const { return !m_events.empty(); }
+
+	// < Looks each recorded type up once, as resolve(type), and keeps the
+	// * handle on every event of that type.
+	template <typename F>
+	void ResolveTypes(F resolve)
+	{
+		std::map<std::string, FactoryHandle> handles;
+
+		for (auto& event : m_events)
+		{
+			auto find = handles.find(event.type);
+			if (find == handles.end()) { find = handles.insert(std::make_pair(event.type, resolve(event.type))).first; }
+
+			event.handle = find->second;
+		}
+	}
+	bool                                        Finished(void) const { return m_nCursor >= m_events.size(); }
+
+	// < Calls onEvent for every recorded event of the given frame, in the
+	// * order they were recorded. Frames must be played in increasing order.
+	template <typename F>
+	void Play(uint32_t nFrame, F onEvent)
+	{
+		while (m_nCursor < m_events.size() && m_events[m_nCursor].nFrame <= nFrame)
+		{
+			if (m_events[m_nCursor].nFrame == nFrame) { onEvent(m_events[m_nCursor]); }
+			m_nCursor += 1;
+		}
+	}
+
+private:
+
+	std::vector<RecordedEvent>                  m_events;
+	size_t                                      m_nCursor;
+
+}; // < end class.
+
+#endif // _EVENT_RECORDER_HPP_
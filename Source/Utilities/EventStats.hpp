@@ -0,0 +1,66 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: EventStats.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for EventStats utility.
+                 The EventStats structures hold the
+                 dispatch counters, queue latency and
+                 per-listener cost recorded by the
+                 EventManager for a single event type.
+
+---------------------------------------------------------*/
+
+#ifndef _EVENT_STATS_HPP_
+	#define _EVENT_STATS_HPP_
+
+#pragma once
+#include "Histogram.hpp"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+
+/* Time spent inside a single listener delegate. */
+struct ListenerStats
+{
+	uint64_t                          nCalls;         /* The number of times the listener was invoked. */
+	uint64_t                          nTotalMicros;   /* The total time spent inside the listener. */
+	uint64_t                          nMaxMicros;     /* The longest single invocation. */
+
+	ListenerStats(void) : nCalls(0), nTotalMicros(0), nMaxMicros(0) { }
+
+	void Add(uint64_t nMicros)
+	{
+		nCalls += 1;
+		nTotalMicros += nMicros;
+		if (nMicros > nMaxMicros) { nMaxMicros = nMicros; }
+	}
+
+}; // < end struct.
+
+/* Everything recorded for a single event type. Listeners are keyed by their
+   - bound instance and function stub. */
+template <typename ListenerKey>
+struct EventStats
+{
+	uint64_t                          nQueued;        /* Events accepted by QueueEvent. */
+	uint64_t                          nDispatched;    /* Queued events handed to listeners. */
+	uint64_t                          nTriggered;     /* Events dispatched immediately by TriggerEvent. */
+	uint64_t                          nAborted;       /* Queued events removed by AbortEvent. */
+
+	Histogram                         latency;        /* Microseconds between queueing and dispatch. */
+
+	std::map<ListenerKey, ListenerStats> listeners;
+
+	EventStats(void) : nQueued(0), nDispatched(0), nTriggered(0), nAborted(0) { }
+
+}; // < end struct.
+
+#endif // _EVENT_STATS_HPP_
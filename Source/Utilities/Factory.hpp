@@ -12,19 +12,32 @@
     Description: Header file for Factory utility.
                  The Factory class provides a clean way
                  to easily register and create objects
-                 of a similar base class.
+                 of a similar base class. Makers are kept
+                 in a flat array indexed by handle, and
+                 every maker recycles its instances from
+                 its own pool.
     
     Functions: 1. T* Create(const std::string& objType);
+
+               2. T* Create(FactoryHandle handle);
+
+               3. FactoryHandle Resolve(const std::string& objType);
+
+               4. void Destroy(T* pObject);
                                                          
-               2. void Register(FactoryYupe* pMaker);
+               5. FactoryHandle Register(FactoryType* pMaker);
                
-               3. void Unregister(const std::string& objType);
+               6. void Unregister(const std::string& objType);
                
     Example:
      
         Factory<State> gStateFactory;
         
         gStateFactory.Register(new FactoryMaker<DefaultState, State>);
+
+        FactoryHandle handle = gStateFactory.Resolve(DefaultState::ClassType());
+        State* pState = gStateFactory.Create(handle);
+        gStateFactory.Destroy(pState);
     
         gStateFactory.Unregister(DefaultState::ClassType());
 
@@ -34,35 +47,148 @@
 	#define _FACTORY_HPP_
 
 #pragma once
+#include "StringId.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #define CLASS_TYPE(classname) \
 	public: \
 		virtual const char* ObjectType() { return ClassType(); } \
-		static const char* ClassType() { return #classname; }
+		static const char* ClassType() { return #classname; } \
+		virtual StringId ObjectId() { return ClassId(); } \
+		static StringId ClassId() { \
+			struct Tag { static const char* Name() { return #classname; } }; \
+			(void)(StringIdRegistrar<Tag>::s_bRegistered); \
+			return StringId(#classname); \
+		}
+
+typedef uint32_t FactoryHandle;
+
+/* The handle returned for types that were never registered. */
+#define INVALID_FACTORY_HANDLE 0xffffffff
+
+template <typename T>
+class Factory;
+
+template <typename T>
+class FactoryMakerBase;
+
+/* Precedes every pooled instance, pointing back at the maker that owns it so
+   the object can be destroyed through its base class. */
+template <typename T>
+struct alignas(std::max_align_t) FactorySlot
+{
+	FactoryMakerBase<T>*	pMaker;
+	FactorySlot*			pNext;
+};
 
 template <typename T>
 class FactoryMakerBase
 {
+	friend class Factory<T>;
+
 public:
-	virtual T* Create() const = 0;
+	FactoryMakerBase(void) : m_nLive(0), m_bRetired(false) { }
+	virtual ~FactoryMakerBase() { }
+
+	virtual T* Create() = 0;
+	virtual void Destroy(T* pObject) = 0;
 	virtual const char* ObjectType() const = 0;
+
+	/* The number of instances created and not yet destroyed */
+	size_t Live(void) const { return m_nLive; }
+
+protected:
+	size_t m_nLive;
+
+private:
+	bool m_bRetired;	// Unregistered while instances were alive; deleted with the last of them.
 }; // end class FactoryMakerBase.
 
 template <typename Type, typename Base>
 class FactoryMaker : public FactoryMakerBase < Base >
 {
+	typedef FactorySlot<Base> Slot;
+
+	/* Objects are carved out of blocks of about 4kb, at least one per block */
+	enum { SLOT_SIZE = sizeof(Slot) + ((sizeof(Type) + sizeof(Slot) - 1) / sizeof(Slot)) * sizeof(Slot) };
+	enum { SLOTS_PER_BLOCK = (SLOT_SIZE >= 4096) ? 1 : (4096 / SLOT_SIZE) };
+
+	static_assert(alignof(Type) <= alignof(Slot), "Type is over-aligned for the factory pool.");
+
 public:
-	virtual Base* Create() const
+	FactoryMaker(void) : m_pFree(nullptr) { }
+
+	virtual ~FactoryMaker()
     {
-		return new Type;
+		assert(this->m_nLive == 0);	// The factory retires makers with live instances instead of deleting them.
+
+		for (size_t i = 0; i < m_blocks.size(); i++) { ::operator delete(m_blocks[i]); }
+	}
+
+	virtual Base* Create()
+    {
+		if (m_pFree == nullptr) { Grow(); }
+
+		Slot* pSlot = m_pFree;
+		m_pFree = pSlot->pNext;
+		pSlot->pMaker = this;
+		pSlot->pNext = nullptr;
+
+		Type* pObject = new (pSlot + 1) Type;
+		assert((void*)(static_cast<Base*>(pObject)) == (void*)(pObject));	// Base must sit at the start of Type.
+
+		this->m_nLive += 1;
+		return pObject;
+	}
+
+	virtual void Destroy(Base* pObject)
+    {
+		assert(pObject != nullptr);
+
+		Slot* pSlot = reinterpret_cast<Slot*>(pObject) - 1;
+		assert(pSlot->pMaker == this);	// Object was not created by this maker.
+
+		static_cast<Type*>(pObject)->~Type();
+
+		pSlot->pMaker = nullptr;
+		pSlot->pNext = m_pFree;
+		m_pFree = pSlot;
+
+		this->m_nLive -= 1;
 	}
 
 	virtual const char* ObjectType() const
     {
 		return Type::ClassType();
 	}
+
+private:
+
+	void Grow(void)
+    {
+		char* pBlock = static_cast<char*>(::operator new(SLOT_SIZE * SLOTS_PER_BLOCK));
+		m_blocks.push_back(pBlock);
+
+		for (size_t i = 0; i < SLOTS_PER_BLOCK; i++)
+        {
+			Slot* pSlot = reinterpret_cast<Slot*>(pBlock + i * SLOT_SIZE);
+			pSlot->pMaker = nullptr;
+			pSlot->pNext = m_pFree;
+			m_pFree = pSlot;
+		}
+	}
+
+	std::vector<char*> m_blocks;
+	Slot* m_pFree;
+
 }; // end class FactoryMaker.
 
 template <typename T>
@@ -71,43 +197,108 @@ public:
 	typedef FactoryMakerBase<T> FactoryType;
 
 	T* Create(const std::string& objType);
-	void Register(FactoryType* pMaker);
+	T* Create(FactoryHandle handle);
+	void Destroy(T* pObject);
+
+	FactoryHandle Resolve(const std::string& objType) const;
+
+	FactoryHandle Register(FactoryType* pMaker);
 	void Unregister(const std::string& objType);
 
 private:
-	typedef std::map<std::string, FactoryType*> TypeMap;
-	TypeMap m_makers;
+	void Release(FactoryType* pMaker);
+
+	typedef std::map<std::string, FactoryHandle> HandleMap;
+	HandleMap m_handles;
+	std::vector<FactoryType*> m_makers;
 }; // end class Factory.
 
 template <typename T>
-void Factory<T>::Register(FactoryType* pMaker)
+FactoryHandle Factory<T>::Register(FactoryType* pMaker)
 {
 	assert(pMaker != nullptr);
-	m_makers[std::string(pMaker->ObjectType())] = pMaker;
+
+	/* A type keeps its handle across re-registration, so resolved handles stay valid */
+	FactoryHandle handle = Resolve(pMaker->ObjectType());
+	if (handle == INVALID_FACTORY_HANDLE)
+    {
+		handle = (FactoryHandle)(m_makers.size());
+		m_makers.push_back(nullptr);
+		m_handles[std::string(pMaker->ObjectType())] = handle;
+	}
+
+	if (m_makers[handle] != pMaker) { Release(m_makers[handle]); }
+	m_makers[handle] = pMaker;
+
+	return handle;
 } // end Register.
 
 template <typename T>
 void Factory<T>::Unregister(const std::string& objType)
 {
-	typename TypeMap::iterator it = m_makers.find(objType);
-	if (it != m_makers.end())
+	FactoryHandle handle = Resolve(objType);
+	if (handle != INVALID_FACTORY_HANDLE && m_makers[handle] != nullptr)
     {
-		FactoryType* pMaker = (*it).second;
-		assert(pMaker != nullptr);
-		delete pMaker;
-		m_makers.erase(it);
+		Release(m_makers[handle]);
+		m_makers[handle] = nullptr;
 	}
 } // end Unregister.
 
+template <typename T>
+FactoryHandle Factory<T>::Resolve(const std::string& objType) const
+{
+	typename HandleMap::const_iterator it = m_handles.find(objType);
+	if (it == m_handles.end())
+		return INVALID_FACTORY_HANDLE;
+
+	return (*it).second;
+} // end Resolve.
+
 template <typename T>
 T* Factory<T>::Create(const std::string& objType)
 {
-	typename TypeMap::iterator it = m_makers.find(objType);
-	if (it == m_makers.end())
+	return Create(Resolve(objType));
+} // end Create.
+
+template <typename T>
+T* Factory<T>::Create(FactoryHandle handle)
+{
+	if (handle >= m_makers.size() || m_makers[handle] == nullptr)
 		return nullptr;
 
-	FactoryType* pMaker = (*it).second;
-	return pMaker->Create();
+	return m_makers[handle]->Create();
 } // end Create.
 
-#endif // _FACTORY_HPP_
\ No newline at end of file
+template <typename T>
+void Factory<T>::Destroy(T* pObject)
+{
+	if (pObject == nullptr)
+		return;
+
+	/* Every instance is preceded by the slot naming the maker that pooled it */
+	FactorySlot<T>* pSlot = reinterpret_cast<FactorySlot<T>*>(pObject) - 1;
+	assert(pSlot->pMaker != nullptr);	// Object was not created by a factory, or was already destroyed.
+
+	FactoryType* pMaker = pSlot->pMaker;
+	pMaker->Destroy(pObject);
+
+	if (pMaker->m_bRetired && pMaker->Live() == 0) { delete pMaker; }
+} // end Destroy.
+
+template <typename T>
+void Factory<T>::Release(FactoryType* pMaker)
+{
+	if (pMaker == nullptr)
+		return;
+
+	/* Instances still alive need their maker's pool; it is deleted with the last of them */
+	if (pMaker->Live() != 0)
+    {
+		pMaker->m_bRetired = true;
+		return;
+	}
+
+	delete pMaker;
+} // end Release.
+
+#endif // _FACTORY_HPP_
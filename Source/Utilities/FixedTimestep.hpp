@@ -0,0 +1,127 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: FixedTimestep.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for FixedTimestep utility.
+                 The FixedTimestep turns a variable frame
+                 time into a whole number of fixed steps.
+                 Time left over is carried to the next
+                 frame, and its fraction of a step is the
+                 alpha to interpolate the presented frame
+                 by. A slow frame catches up with at most
+                 a few steps; anything beyond that is let
+                 go rather than snowballing.
+
+                 Times are in Leadwerks' speed units,
+                 where 1.0 is a 60th of a second.
+
+    Functions: 1. unsigned Advance(float fDelta);
+
+               2. float StepDelta(void) const;
+
+               3. float Alpha(void) const;
+
+    Example:
+
+        FixedTimestep timestep(30);
+
+        unsigned nSteps = timestep.Advance(deltaTime);
+        while (nSteps-- != 0) { Simulate(timestep.StepDelta()); }
+
+        Present(timestep.Alpha());
+
+---------------------------------------------------------*/
+
+#ifndef _FIXED_TIMESTEP_HPP_
+	#define _FIXED_TIMESTEP_HPP_
+
+#pragma once
+#include <cstdint>
+
+class FixedTimestep
+{
+public:
+
+	enum { DEFAULT_TICK_RATE = 60, DEFAULT_MAX_STEPS = 5 };
+
+	FixedTimestep(unsigned nTickRate = DEFAULT_TICK_RATE, unsigned nMaxSteps = DEFAULT_MAX_STEPS)
+		: m_fAccumulator(0.0f), m_fAlpha(0.0f), m_nMaxSteps(nMaxSteps), m_nTicks(0), m_nDropped(0)
+	{
+		SetTickRate(nTickRate);
+	}
+
+	/* Steps per second. 0 steps once per frame with the frame's own time. */
+	void SetTickRate(unsigned nTickRate)
+	{
+		m_nTickRate = nTickRate;
+		m_fStep = (nTickRate != 0) ? (60.0f / (float)(nTickRate)) : 0.0f;
+		m_fAccumulator = 0.0f;
+		m_fAlpha = 0.0f;
+	}
+
+	unsigned TickRate(void) const { return m_nTickRate; }
+
+	/* The most steps a single frame may run */
+	void SetMaxSteps(unsigned nMaxSteps) { m_nMaxSteps = (nMaxSteps != 0) ? nMaxSteps : 1; }
+	unsigned MaxSteps(void) const { return m_nMaxSteps; }
+
+	/* Adds a frame's time and returns how many steps to run for it */
+	unsigned Advance(float fDelta)
+	{
+		if (m_nTickRate == 0) {
+			m_fStep = fDelta;
+			m_fAlpha = 1.0f;
+			m_nTicks += 1;
+
+			return 1;
+		}
+
+		m_fAccumulator += (fDelta > 0.0f) ? fDelta : 0.0f;
+
+		unsigned nSteps = (unsigned)(m_fAccumulator / m_fStep);
+		m_fAccumulator -= (float)(nSteps) * m_fStep;
+
+		// < Past the cap, the time is dropped and the simulation runs slow
+		// * rather than spending ever longer catching up.
+		if (nSteps > m_nMaxSteps) {
+			m_nDropped += nSteps - m_nMaxSteps;
+			nSteps = m_nMaxSteps;
+		}
+
+		m_fAlpha = m_fAccumulator / m_fStep;
+		m_nTicks += nSteps;
+
+		return nSteps;
+	}
+
+	/* The time each step simulates */
+	float StepDelta(void) const { return m_fStep; }
+
+	/* How far the presented frame is between the last step and the next, in
+	   [0, 1). Always 1 when stepping once per frame. */
+	float Alpha(void) const { return m_fAlpha; }
+
+	uint64_t Ticks(void) const { return m_nTicks; }
+	uint64_t Dropped(void) const { return m_nDropped; }
+
+private:
+
+	unsigned    m_nTickRate;
+	float       m_fStep;
+	float       m_fAccumulator;     // Time not yet simulated, less than a step.
+	float       m_fAlpha;
+	unsigned    m_nMaxSteps;
+
+	uint64_t    m_nTicks;           // Steps run so far.
+	uint64_t    m_nDropped;         // Steps let go by the catch-up cap.
+
+}; // < end class.
+
+#endif // _FIXED_TIMESTEP_HPP_
@@ -0,0 +1,120 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: Histogram.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for Histogram utility.
+                 The Histogram class records integer
+                 samples (typically microseconds) into
+                 fixed log-linear buckets, allowing cheap
+                 recording and approximate percentiles.
+
+    Functions: 1. void Add(uint64_t nValue);
+
+               2. uint64_t Percentile(float fPercent) const;
+
+               3. void Merge(const Histogram& other);
+
+               4. void Reset(void);
+
+---------------------------------------------------------*/
+
+#ifndef _HISTOGRAM_HPP_
+	#define _HISTOGRAM_HPP_
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+class Histogram
+{
+	// < Values below 8 get a bucket each; every power of two above that is
+	// * split into four buckets, keeping each reading within 25% of the
+	// * recorded value.
+	enum eConstants { LINEAR = 8, SUB_BITS = 2, SUB_BUCKETS = 1 << SUB_BITS, NUM_BUCKETS = 256 };
+
+public:
+
+	Histogram(void) { Reset(); }
+
+	void Add(uint64_t nValue)
+	{
+		m_buckets[BucketOf(nValue)] += 1;
+		m_nCount += 1;
+		m_nTotal += nValue;
+		if (nValue > m_nMax) { m_nMax = nValue; }
+	}
+
+	void Merge(const Histogram& other)
+	{
+		for (int i = 0; i < NUM_BUCKETS; i++) { m_buckets[i] += other.m_buckets[i]; }
+		m_nCount += other.m_nCount;
+		m_nTotal += other.m_nTotal;
+		if (other.m_nMax > m_nMax) { m_nMax = other.m_nMax; }
+	}
+
+	void Reset(void)
+	{
+		memset(m_buckets, 0, sizeof(m_buckets));
+		m_nCount = m_nTotal = m_nMax = 0;
+	}
+
+	// < Returns the lower bound of the bucket holding the given percentile
+	// * (0 - 100) of all recorded samples.
+	uint64_t Percentile(float fPercent) const
+	{
+		if (m_nCount == 0) { return 0; }
+
+		uint64_t target = (uint64_t)((fPercent / 100.0f) * (float)(m_nCount));
+		if (target >= m_nCount) { target = m_nCount - 1; }
+
+		uint64_t seen = 0;
+		for (int i = 0; i < NUM_BUCKETS; i++)
+		{
+			seen += m_buckets[i];
+			if (seen > target) { return LowerBound(i); }
+		}
+
+		return m_nMax;
+	}
+
+	uint64_t Count(void) const { return m_nCount; }
+	uint64_t Max(void) const { return m_nMax; }
+	uint64_t Mean(void) const { return (m_nCount != 0) ? (m_nTotal / m_nCount) : 0; }
+
+private:
+
+	static int BucketOf(uint64_t nValue)
+	{
+		if (nValue < LINEAR) { return (int)(nValue); }
+
+		int msb = 63;
+		while ((nValue & (1ull << msb)) == 0) { msb -= 1; }
+
+		int sub = (int)((nValue >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+		return LINEAR + (msb - 3) * SUB_BUCKETS + sub;
+	}
+
+	static uint64_t LowerBound(int nBucket)
+	{
+		if (nBucket < LINEAR) { return (uint64_t)(nBucket); }
+
+		int msb = ((nBucket - LINEAR) / SUB_BUCKETS) + 3;
+		int sub = (nBucket - LINEAR) % SUB_BUCKETS;
+		return (1ull << msb) + ((uint64_t)(sub) << (msb - SUB_BITS));
+	}
+
+	uint64_t m_buckets[NUM_BUCKETS];
+	uint64_t m_nCount;
+	uint64_t m_nTotal;
+	uint64_t m_nMax;
+
+}; // < end class.
+
+#endif // _HISTOGRAM_HPP_
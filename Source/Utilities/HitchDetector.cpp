@@ -0,0 +1,202 @@
+#pragma once
+#include "HitchDetector.hpp"
+#include "AllocationCounter.hpp"
+#include "Timer.hpp"
+
+#include "../Managers/EventManager.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+HitchDetector gHitchDetector;
+
+// < The trace thread id the frames themselves are drawn on, well clear of
+// * the ids the Profiler hands out.
+static const uint32_t FRAME_THREAD_ID = 1000000;
+
+HitchDetector::HitchDetector(void)
+	: m_bStarted(false), m_nThresholdMicros(0), m_nMaxDumps(DEFAULT_MAX_DUMPS), m_pEventManager(nullptr)
+	, m_nNext(0), m_nFrame(0), m_nAftermath(0), m_nPendingFrame(0), m_nPendingMicros(0), m_nPendingHitches(0)
+	, m_nLastEvents(0), m_nLastAllocations(0), m_nLastAllocatedBytes(0), m_nHitches(0), m_nSuppressed(0), m_nDumps(0)
+{
+	SetWindow(DEFAULT_FRAMES);
+}
+
+void HitchDetector::Start(uint64_t nThresholdMicros, const std::string& cDirectory)
+{
+	m_nThresholdMicros = nThresholdMicros;
+	m_cDirectory = cDirectory;
+
+	m_nLastEvents = (m_pEventManager != nullptr) ? m_pEventManager->DispatchCount() : 0;
+	m_nLastAllocations = AllocationCounter::Count();
+	m_nLastAllocatedBytes = AllocationCounter::Bytes();
+
+	m_bStarted = true;
+}
+
+void HitchDetector::Stop(void)
+{
+	if (!m_bStarted) { return; }
+
+	// < A hitch near the end of the run is written with what aftermath it has.
+	if (m_nAftermath != 0) {
+		m_nAftermath = 0;
+		Dump();
+	}
+
+	m_bStarted = false;
+
+	if (m_nSuppressed != 0) {
+		std::cout << m_nSuppressed << " of " << m_nHitches << " hitches were not written; the dump limit was reached, or the last dump was still being written. \n";
+	}
+}
+
+void HitchDetector::SetWindow(size_t nFrames)
+{
+	m_frames.clear();
+	m_frames.resize((nFrames != 0) ? nFrames : 1);
+
+	m_nNext = 0;
+	m_nFrame = 0;
+	m_nAftermath = 0;
+}
+
+void HitchDetector::EndFrame(void)
+{
+	if (!m_bStarted) { return; }
+
+	uint64_t nEvents = (m_pEventManager != nullptr) ? m_pEventManager->DispatchCount() : 0;
+	uint64_t nAllocations = AllocationCounter::Count();
+	uint64_t nAllocatedBytes = AllocationCounter::Bytes();
+
+	// < Records are reused, so once the window has filled the samples are
+	// * copied into storage that is already large enough.
+	FrameRecord& record = m_frames[m_nNext];
+	record.nFrame = m_nFrame;
+	record.nDurationMicros = gProfiler.FrameMicros();
+	record.nBeginMicros = Timer::Micros() - record.nDurationMicros;
+	record.nEvents = nEvents - m_nLastEvents;
+	record.nAllocations = nAllocations - m_nLastAllocations;
+	record.nAllocatedBytes = nAllocatedBytes - m_nLastAllocatedBytes;
+	record.samples.assign(gProfiler.LastFrame().begin(), gProfiler.LastFrame().end());
+
+	m_nLastEvents = nEvents;
+	m_nLastAllocations = nAllocations;
+	m_nLastAllocatedBytes = nAllocatedBytes;
+
+	m_nNext = (m_nNext + 1) % m_frames.size();
+	m_nFrame += 1;
+
+	bool bHitch = (record.nDurationMicros > m_nThresholdMicros);
+	if (bHitch) { m_nHitches += 1; }
+
+	// < A hitch in the aftermath of a pending one is written in the same
+	// * file, once the aftermath has run.
+	if (m_nAftermath != 0) {
+		if (bHitch) { m_nPendingHitches += 1; }
+		if (--m_nAftermath == 0) { Dump(); }
+
+		return;
+	}
+
+	if (!bHitch) { return; }
+
+	// < Writing happens off the main thread so the dump does not cause the
+	// * next hitch; a hitch that cannot be written is only counted.
+	bool bWriting = m_writer.valid() && m_writer.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+	if (m_nDumps >= m_nMaxDumps || bWriting) {
+		m_nSuppressed += 1;
+		return;
+	}
+
+	m_nPendingFrame = record.nFrame;
+	m_nPendingMicros = record.nDurationMicros;
+	m_nPendingHitches = 1;
+	m_nAftermath = m_frames.size() / 2;
+
+	if (m_nAftermath == 0) { Dump(); }
+}
+
+void HitchDetector::Dump(void)
+{
+	// < Oldest frame first.
+	std::vector<FrameRecord> frames;
+	size_t nCount = (m_nFrame < m_frames.size()) ? (size_t)(m_nFrame) : m_frames.size();
+	size_t nFirst = (m_nNext + m_frames.size() - nCount) % m_frames.size();
+
+	frames.reserve(nCount);
+	for (size_t i = 0; i < nCount; i++) { frames.push_back(m_frames[(nFirst + i) % m_frames.size()]); }
+
+	std::ostringstream path;
+	path << m_cDirectory << "/hitch_" << m_nPendingFrame << ".json";
+
+	std::string cPath = path.str();
+	uint64_t nThresholdMicros = m_nThresholdMicros;
+	uint64_t nHitchFrame = m_nPendingFrame;
+	unsigned nHitches = m_nPendingHitches;
+
+	m_writer = std::async(std::launch::async, [frames, cPath, nThresholdMicros, nHitchFrame, nHitches]() {
+		std::ofstream out(cPath.c_str(), std::ios::out | std::ios::trunc);
+		if (!out.is_open()) { return false; }
+
+		WriteTrace(out, frames, nThresholdMicros, nHitchFrame, nHitches);
+		return true;
+	});
+
+	m_nDumps += 1;
+
+	std::cout << "Frame " << m_nPendingFrame << " took " << m_nPendingMicros << "us; writing \"" << cPath << "\"";
+	if (nHitches > 1) { std::cout << " with " << (nHitches - 1) << " more hitches after it"; }
+	std::cout << ". \n";
+}
+
+void HitchDetector::WriteTrace(std::ostream& out, const std::vector<FrameRecord>& frames, uint64_t nThresholdMicros,
+	uint64_t nHitchFrame, unsigned nHitches)
+{
+	// < Worker-thread samples may have started before the frame that
+	// * drained them, so the origin is the earliest of everything.
+	uint64_t nOriginMicros = frames.empty() ? 0 : frames.front().nBeginMicros;
+	for (auto& frame : frames)
+	{
+		if (frame.nBeginMicros < nOriginMicros) { nOriginMicros = frame.nBeginMicros; }
+		for (auto& sample : frame.samples)
+		{
+			if (sample.sample.nBeginMicros < nOriginMicros) { nOriginMicros = sample.sample.nBeginMicros; }
+		}
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\""
+		<< ",\"otherData\":{\"thresholdMicros\":" << nThresholdMicros
+		<< ",\"hitchFrame\":" << nHitchFrame
+		<< ",\"hitches\":" << nHitches << "}"
+		<< ",\"traceEvents\":[";
+
+	out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << FRAME_THREAD_ID << ",\"args\":{\"name\":\"Frames\"}}";
+
+	for (auto& frame : frames)
+	{
+		out << ",\n{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1"
+			<< ",\"tid\":" << FRAME_THREAD_ID
+			<< ",\"ts\":" << (frame.nBeginMicros - nOriginMicros)
+			<< ",\"dur\":" << frame.nDurationMicros
+			<< ",\"args\":{\"frame\":" << frame.nFrame
+			<< ",\"events\":" << frame.nEvents;
+
+		// < Without the counter there is nothing to report, rather than 0.
+		if (AllocationCounter::Enabled()) {
+			out << ",\"allocations\":" << frame.nAllocations
+				<< ",\"allocatedBytes\":" << frame.nAllocatedBytes << "}}";
+		}
+		else { out << ",\"allocations\":\"n/a\",\"allocatedBytes\":\"n/a\"}}"; }
+
+		for (auto& sample : frame.samples)
+		{
+			out << ",\n";
+			Profiler::WriteTraceEvent(out, sample, nOriginMicros);
+		}
+	}
+
+	out << "\n]}\n";
+}
@@ -0,0 +1,133 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: HitchDetector.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for HitchDetector utility.
+                 The HitchDetector keeps the last few
+                 frames: their profiler scopes, events
+                 dispatched and allocations made. When a
+                 frame runs over the threshold, the frames
+                 before it and, once they have run, the
+                 frames after it are written to disk as a
+                 Chrome trace, turning a rare spike into a
+                 file that can be opened in chrome://tracing.
+                 Hitches that cannot be written are counted
+                 and reported when the detector stops.
+
+    Functions: 1. void Start(uint64_t nThresholdMicros, const std::string& cDirectory);
+
+               2. void Watch(const EventManager* pEventManager);
+
+               3. void EndFrame(void);
+
+               4. unsigned Hitches(void) const;
+
+               5. unsigned Suppressed(void) const;
+
+---------------------------------------------------------*/
+
+#ifndef _HITCH_DETECTOR_HPP_
+	#define _HITCH_DETECTOR_HPP_
+
+#pragma once
+#include "Profiler.hpp"
+
+#include <cstdint>
+#include <future>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class EventManager;
+
+class HitchDetector
+{
+public:
+
+	/* Everything kept about a single frame */
+	struct FrameRecord
+	{
+		uint64_t                                nFrame;
+		uint64_t                                nBeginMicros;
+		uint64_t                                nDurationMicros;
+		uint64_t                                nEvents;            // Events dispatched by the EventManager.
+		uint64_t                                nAllocations;
+		uint64_t                                nAllocatedBytes;
+		std::vector<Profiler::ThreadSample>     samples;
+	};
+
+	enum { DEFAULT_FRAMES = 120, DEFAULT_MAX_DUMPS = 16 };
+
+	HitchDetector(void);
+
+	/* Starts watching for frames longer than the given threshold. Each hitch is
+	   written to "hitch_<frame>.json" in the given directory. */
+	void Start(uint64_t nThresholdMicros, const std::string& cDirectory = ".");
+
+	/* Writes a hitch still waiting on its aftermath, and reports any hitches
+	   that were not written */
+	void Stop(void);
+	bool IsStarted(void) const { return m_bStarted; }
+
+	/* The number of frames kept, and so written, per hitch. Half of them
+	   follow the hitch, so its aftermath is in the same file. */
+	void SetWindow(size_t nFrames);
+
+	/* The most hitches written in a run, so a sustained slowdown cannot fill the disk */
+	void SetMaxDumps(unsigned nMaxDumps) { m_nMaxDumps = nMaxDumps; }
+
+	/* Events dispatched by the given EventManager are counted per frame */
+	void Watch(const EventManager* pEventManager) { m_pEventManager = pEventManager; }
+
+	/* Main thread only. Records the frame the Profiler has just ended and
+	   writes the window if it ran over. Call right after Profiler::EndFrame. */
+	void EndFrame(void);
+
+	/* Writes the given frames as Chrome trace-event JSON */
+	static void WriteTrace(std::ostream& out, const std::vector<FrameRecord>& frames, uint64_t nThresholdMicros,
+		uint64_t nHitchFrame, unsigned nHitches);
+
+	unsigned Hitches(void) const { return m_nHitches; }
+	unsigned Suppressed(void) const { return m_nSuppressed; }
+
+private:
+
+	void Dump(void);
+
+	bool                                    m_bStarted;
+	uint64_t                                m_nThresholdMicros;
+	std::string                             m_cDirectory;
+	unsigned                                m_nMaxDumps;
+
+	const EventManager*                     m_pEventManager;
+
+	std::vector<FrameRecord>                m_frames;           // A ring of the last frames; records are reused.
+	size_t                                  m_nNext;            // The record the next frame is written into.
+	uint64_t                                m_nFrame;
+	size_t                                  m_nAftermath;       // Frames left to keep before the pending hitch is written, or 0.
+
+	uint64_t                                m_nPendingFrame;    // The hitch waiting on its aftermath.
+	uint64_t                                m_nPendingMicros;
+	unsigned                                m_nPendingHitches;  // Hitches in its window, itself included.
+
+	uint64_t                                m_nLastEvents;
+	uint64_t                                m_nLastAllocations;
+	uint64_t                                m_nLastAllocatedBytes;
+
+	unsigned                                m_nHitches;         // Hitches seen, written or not.
+	unsigned                                m_nSuppressed;      // Hitches in no written window.
+	unsigned                                m_nDumps;
+	std::future<bool>                       m_writer;           // The last dump, written off the main thread.
+
+}; // < end class.
+
+extern HitchDetector gHitchDetector;
+
+#endif // _HITCH_DETECTOR_HPP_
@@ -318,11 +318,22 @@ void IsoSurface<T>::DeleteSurface() {
 	m_nCellsX = m_nCellsY = m_nCellsZ = 0;
 	m_nCellWidth = m_nCellHeight = m_nCellDepth = 0;
 
+	m_vertexIDs.clear();
+	m_triangles.clear();
+
 	m_bIsValidSurface = false;
 }
 
 template<typename T>
 int IsoSurface<T>::GenerateSurface(Leadwerks::Model& pModel, const T* pScalarField, T nIsoLevel, int nCellsX, int nCellsY, int nCellsZ, float nCellWidth, float nCellHeight, float nCellDepth) {
+	int nTriangles = Polygonise(pScalarField, nIsoLevel, nCellsX, nCellsY, nCellsZ, nCellWidth, nCellHeight, nCellDepth);
+	BuildModel(pModel);
+
+	return nTriangles;
+}
+
+template<typename T>
+int IsoSurface<T>::Polygonise(const T* pScalarField, T nIsoLevel, int nCellsX, int nCellsY, int nCellsZ, float nCellWidth, float nCellHeight, float nCellDepth) {
 	if (m_bIsValidSurface) {
 		DeleteSurface();
 	}
@@ -458,13 +469,18 @@ int IsoSurface<T>::GenerateSurface(Leadwerks::Model& pModel, const T* pScalarFie
 					}
 				}
 			}
-	
-	GenerateLeadwerksSurface(pModel);
 
 	m_bIsValidSurface = true;
 	return nTriangles;
 }
 
+template<typename T>
+void IsoSurface<T>::BuildModel(Leadwerks::Model& pModel) {
+	if (!m_bIsValidSurface) { return; }
+
+	GenerateLeadwerksSurface(pModel);
+}
+
 template<typename T>
 void IsoSurface<T>::GenerateLeadwerksSurface(Leadwerks::Model& pModel) {
 	Leadwerks::Surface* pSurface = pModel.AddSurface();
@@ -13,13 +13,20 @@
                  The IsoSurface class provides a clean
                  interface for generating an implicit
                  model surface within a Leadwerks::Model
-                 using Marching Cubes.
+                 using Marching Cubes. Polygonise only
+                 touches the scalar field, so it can run
+                 away from the main thread; BuildModel
+                 then hands the triangles to Leadwerks.
     
     Functions: 1. int GenerateSurface(Leadwerks::Model& pModel, const T* pScalarField, T nIsoLevel, int nCellsX, int nCellsY, int nCellsZ, float nCellWidth, float nCellHeight, float nCellDepth);
                                                          
-               2. void DeleteSurface(void);
+               2. int Polygonise(const T* pScalarField, T nIsoLevel, int nCellsX, int nCellsY, int nCellsZ, float nCellWidth, float nCellHeight, float nCellDepth);
+
+               3. void BuildModel(Leadwerks::Model& pModel);
+
+               4. void DeleteSurface(void);
                
-               3. bool IsSurfaceValid(void)    
+               5. bool IsSurfaceValid(void)    
 
 ---------------------------------------------------------*/
 
@@ -47,6 +54,9 @@ public:
 
 	int GenerateSurface(Leadwerks::Model& pModel, const T* pScalarField, T nIsoLevel, int nCellsX, int nCellsY, int nCellsZ, float nCellWidth, float nCellHeight, float nCellDepth);	
 
+	int Polygonise(const T* pScalarField, T nIsoLevel, int nCellsX, int nCellsY, int nCellsZ, float nCellWidth, float nCellHeight, float nCellDepth);
+	void BuildModel(Leadwerks::Model& pModel);
+
 	void DeleteSurface();
 
 	bool IsSurfaceValid() { return m_bIsValidSurface; }
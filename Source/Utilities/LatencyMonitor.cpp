@@ -0,0 +1,106 @@
+#pragma once
+#include "LatencyMonitor.hpp"
+#include "Timer.hpp"
+
+#include <fstream>
+
+LatencyMonitor gLatencyMonitor;
+
+void LatencyMonitor::MarkInput(uint64_t nMicros)
+{
+	uint64_t nInputMicros = m_nInputMicros.load(std::memory_order_relaxed);
+
+	while (nInputMicros == 0 || nMicros < nInputMicros)
+	{
+		if (m_nInputMicros.compare_exchange_weak(nInputMicros, nMicros, std::memory_order_acq_rel)) { return; }
+	}
+}
+
+void LatencyMonitor::MarkApplied(void)
+{
+	uint64_t nInputMicros = m_nInputMicros.load(std::memory_order_acquire);
+	if (nInputMicros == 0) { return; }
+
+	// < Only the first apply after the input is measured.
+	uint64_t nAppliedMicros = 0;
+	uint64_t nowMicros = Timer::Micros();
+	if (!m_nAppliedMicros.compare_exchange_strong(nAppliedMicros, nowMicros, std::memory_order_acq_rel)) { return; }
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_inputToApplied.Add(nowMicros - nInputMicros);
+}
+
+void LatencyMonitor::MarkPresented(void)
+{
+	uint64_t nInputMicros, nAppliedMicros;
+	TakePending(nInputMicros, nAppliedMicros);
+
+	Present(nInputMicros, nAppliedMicros);
+}
+
+void LatencyMonitor::TakePending(uint64_t& nInputMicros, uint64_t& nAppliedMicros)
+{
+	nAppliedMicros = m_nAppliedMicros.exchange(0, std::memory_order_acq_rel);
+	nInputMicros = m_nInputMicros.exchange(0, std::memory_order_acq_rel);
+}
+
+void LatencyMonitor::Present(uint64_t nInputMicros, uint64_t nAppliedMicros)
+{
+	if (nInputMicros == 0) { return; }
+
+	uint64_t nowMicros = Timer::Micros();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// < Input that never reached an Input component, e.g. a key with no
+	// * binding, still counts towards the total.
+	if (nAppliedMicros != 0) { m_appliedToPresent.Add(nowMicros - nAppliedMicros); }
+	m_inputToPresent.Add(nowMicros - nInputMicros);
+}
+
+void LatencyMonitor::Reset(void)
+{
+	m_nInputMicros.store(0, std::memory_order_release);
+	m_nAppliedMicros.store(0, std::memory_order_release);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_inputToApplied.Reset();
+	m_appliedToPresent.Reset();
+	m_inputToPresent.Reset();
+}
+
+void LatencyMonitor::Dump(std::ostream& out) const
+{
+	struct Stage { const char* cName; const Histogram* pHistogram; };
+	const Stage stages[] =
+	{
+		{ "input -> applied", &m_inputToApplied },
+		{ "applied -> present", &m_appliedToPresent },
+		{ "input -> present", &m_inputToPresent }
+	};
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	out << "Input latency\n";
+	for (auto& stage : stages)
+	{
+		const Histogram& histogram = *stage.pHistogram;
+
+		out << "  " << stage.cName
+			<< ": samples " << histogram.Count()
+			<< ", mean " << histogram.Mean() << "us"
+			<< ", p50 " << histogram.Percentile(50.0f) << "us"
+			<< ", p95 " << histogram.Percentile(95.0f) << "us"
+			<< ", p99 " << histogram.Percentile(99.0f) << "us"
+			<< ", max " << histogram.Max() << "us\n";
+	}
+}
+
+bool LatencyMonitor::DumpToFile(const std::string& cPath) const
+{
+	std::ofstream out(cPath.c_str(), std::ios::out | std::ios::trunc);
+	if (!out.is_open()) { return false; }
+
+	Dump(out);
+	return true;
+}
@@ -0,0 +1,99 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: LatencyMonitor.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for LatencyMonitor utility.
+                 The LatencyMonitor measures how long
+                 input takes to reach the screen. Input
+                 is marked when the InputManager sees it,
+                 again when it is written into the Input
+                 components, and once more when the frame
+                 is handed to Context::Sync. Each stage
+                 is kept in its own Histogram.
+                 Input is marked by the simulation and
+                 presented by the render thread, so the
+                 pending times are atomic and the
+                 histograms are guarded by a mutex.
+
+    Functions: 1. void MarkInput(uint64_t nMicros);
+
+               2. void MarkApplied(void);
+
+               3. void MarkPresented(void);
+
+               4. void TakePending(uint64_t& nInputMicros, uint64_t& nAppliedMicros);
+
+               5. void Present(uint64_t nInputMicros, uint64_t nAppliedMicros);
+
+               6. Histogram InputToPresent(void) const;
+
+               7. bool DumpToFile(const std::string& cPath) const;
+
+---------------------------------------------------------*/
+
+#ifndef _LATENCY_MONITOR_HPP_
+	#define _LATENCY_MONITOR_HPP_
+
+#pragma once
+#include "Histogram.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+class LatencyMonitor
+{
+public:
+
+	LatencyMonitor(void) : m_nInputMicros(0), m_nAppliedMicros(0) { }
+
+	/* Input was seen at the given Timer::Micros() time. Only the oldest input
+	   not yet presented is tracked, so a burst is measured from its start. */
+	void MarkInput(uint64_t nMicros);
+
+	/* The pending input has been written into the Input components */
+	void MarkApplied(void);
+
+	/* The frame showing the pending input has been handed to the context */
+	void MarkPresented(void);
+
+	/* For frames presented on another thread: the simulation takes the pending
+	   input with the frame it builds, and the render thread presents it. */
+	void TakePending(uint64_t& nInputMicros, uint64_t& nAppliedMicros);
+	void Present(uint64_t nInputMicros, uint64_t nAppliedMicros);
+
+	/* Copies, taken under the lock, as another thread may still be adding */
+	Histogram InputToApplied(void) const { std::lock_guard<std::mutex> lock(m_mutex); return m_inputToApplied; }
+	Histogram AppliedToPresent(void) const { std::lock_guard<std::mutex> lock(m_mutex); return m_appliedToPresent; }
+	Histogram InputToPresent(void) const { std::lock_guard<std::mutex> lock(m_mutex); return m_inputToPresent; }
+
+	void Reset(void);
+
+	void Dump(std::ostream& out) const;
+	bool DumpToFile(const std::string& cPath) const;
+
+private:
+
+	std::atomic<uint64_t> m_nInputMicros;       // The oldest input not yet presented, or 0.
+	std::atomic<uint64_t> m_nAppliedMicros;     // When that input was applied, or 0.
+
+	mutable std::mutex  m_mutex;                // Guards the histograms.
+
+	Histogram           m_inputToApplied;       // Microseconds from input to the Input components.
+	Histogram           m_appliedToPresent;     // Microseconds from the Input components to Sync.
+	Histogram           m_inputToPresent;       // Microseconds from input to Sync.
+
+}; // < end class.
+
+extern LatencyMonitor gLatencyMonitor;
+
+#endif // _LATENCY_MONITOR_HPP_
@@ -27,6 +27,8 @@
 #ifndef _MACROS_HPP_
 	#define _MACROS_HPP_
 
+#include "StringId.hpp"
+
 // < Macros
 #define SAFE_DELETE( p )       { if( p ) { delete ( p );     ( p ) = NULL; } }
 #define SAFE_DELETE_ARRAY( p ) { if( p ) { delete[] ( p );   ( p ) = NULL; } }
@@ -35,7 +37,13 @@
 #define CLASS_TYPE(classname) \
 	public: \
 		virtual const char* ObjectType() { return ClassType(); } \
-		static const char* ClassType() { return #classname; }
+		static const char* ClassType() { return #classname; } \
+		virtual StringId ObjectId() { return ClassId(); } \
+		static StringId ClassId() { \
+			struct Tag { static const char* Name() { return #classname; } }; \
+			(void)(StringIdRegistrar<Tag>::s_bRegistered); \
+			return StringId(#classname); \
+		}
 
 // -----
 
@@ -1,18 +1,31 @@
 /*-------------------------------------------------------
                     <copyright>
-    
+
     File: ParameterMap.hpp
     Language: C++
-    
+
     (C) Copyright Eden Softworks
-    
+
     Author: Joshua Allen
     E-Mail: Joshua(AT)EdenSoftworks(DOT)net
-    
+
     Description: Header file for ParameterMap utility.
-                 The ParameterMap provides a convenient 
+                 The ParameterMap provides a convenient
                  way to dynamically add or access
                  different properties of different types.
+                 Properties are keyed by StringId and kept
+                 in a single flat array, so a lookup is a
+                 short linear scan of integer keys.
+
+    Functions: 1. ParameterMap* Set(StringId key, T val);
+
+               2. T Get*(StringId key, T def) const;
+
+               3. bool Has(StringId key) const;
+
+               4. void Remove(StringId key);
+
+               5. size_t Count(void) const;
 
 ---------------------------------------------------------*/
 
@@ -21,57 +34,149 @@
 
 #pragma once
 #include "Leadwerks.h"
+#include "StringId.hpp"
+
+#include <cstdint>
 #include <string>
-#include <map>
+#include <vector>
+
+enum ParameterType : uint8_t
+{
+	PARAMETER_INT = 0,
+	PARAMETER_FLOAT,
+	PARAMETER_VEC3,
+	PARAMETER_STRING,
+	PARAMETER_DATA
+};
 
 struct ParameterMap
 {
-	typedef std::map<std::string, int>::iterator IntMapIterator;
-	typedef std::map<std::string, float>::iterator FloatMapIterator;
-	typedef std::map<std::string, Leadwerks::Vec3>::iterator Vec3MapIterator;
-	typedef std::map<std::string, std::string>::iterator StringMapIterator;		
-	typedef std::map<std::string, void*>::iterator DataMapIterator;
-
-	typedef std::map<std::string, int> IntMap;
-	typedef std::map<std::string, float> FloatMap;
-	typedef std::map<std::string, Leadwerks::Vec3> Vec3Map;
-	typedef std::map<std::string, std::string> StringMap;		
-	typedef std::map<std::string, void*> DataMap;
+	/* A single property. Strings are held out of line, by index. */
+	struct Parameter
+	{
+		uint32_t            nKey;
+		ParameterType       type;
+
+		union
+		{
+			int             nInt;
+			float           fFloat;
+			float           vVec3[3];
+			uint32_t        nString;
+			void*           pData;
+		};
+	};
 
 public:
-	const IntMap& GetIntMap(void) { return intMap; }
-	const FloatMap& GetFloatMap(void) { return floatMap; }
-	const Vec3Map& GetVec3Map(void) { return vec3Map; }
-	const StringMap& GetStringMap(void) { return stringMap; }		
-	const DataMap& GetGameObjectMap(void) { return dataMap; }
-
-	const IntMapIterator GetInt(std::string key) { return intMap.find(key); }
-	const FloatMapIterator GetFloat(std::string key) { return floatMap.find(key); }
-	const Vec3MapIterator GetVec3(std::string key) { return vec3Map.find(key); }
-	const StringMapIterator GetString(std::string key) { return stringMap.find(key); }		
-	const DataMapIterator GetGameObject(std::string key) { return dataMap.find(key); }
-
-	ParameterMap* Set(std::string key, int val) { if (key != "") { intMap[key] = val; } return this; }
-	ParameterMap* Set(std::string key, float val) { if (key != "") { floatMap[key] = val; } return this; }
-	ParameterMap* Set(std::string key, Leadwerks::Vec3 val) { if (key != "") { vec3Map[key] = val; } return this; }
-	ParameterMap* Set(std::string key, std::string val) { if (key != "") { stringMap[key] = val; } return this; }		
-	ParameterMap* Set(std::string key, void* val) { if (key != "") { dataMap[key] = val; return this; } }
-
-	void RemoveInt(std::string key) { if (key != "") { if (intMap.find(key) != intMap.end()) { intMap.erase(key); } } }
-	void RemoveFloat(std::string key) { if (key != "") { if (floatMap.find(key) != floatMap.end()) { floatMap.erase(key); } } }
-	void RemoveVec3(std::string key) { if (key != "") { if (vec3Map.find(key) != vec3Map.end()) { vec3Map.erase(key); } } }
-	void RemoveString(std::string key) { if (key != "") { if (stringMap.find(key) != stringMap.end()) { stringMap.erase(key); } } }		
-	void RemoveGameObject(std::string key) { if (key != "") { if (dataMap.find(key) != dataMap.end()) { dataMap.erase(key); } } }
+	ParameterMap* Set(StringId key, int val) { if (Parameter* p = Slot(key, PARAMETER_INT)) { p->nInt = val; } return this; }
+	ParameterMap* Set(StringId key, float val) { if (Parameter* p = Slot(key, PARAMETER_FLOAT)) { p->fFloat = val; } return this; }
+	ParameterMap* Set(StringId key, Leadwerks::Vec3 val) { if (Parameter* p = Slot(key, PARAMETER_VEC3)) { p->vVec3[0] = val.x; p->vVec3[1] = val.y; p->vVec3[2] = val.z; } return this; }
+	ParameterMap* Set(StringId key, const std::string& val) { if (Parameter* p = Slot(key, PARAMETER_STRING)) { strings[p->nString] = val; } return this; }
+	ParameterMap* Set(StringId key, const char* val) { return Set(key, std::string(val)); }
+	ParameterMap* Set(StringId key, void* val) { if (Parameter* p = Slot(key, PARAMETER_DATA)) { p->pData = val; } return this; }
+
+	int GetInt(StringId key, int def = 0) const { const Parameter* p = Find(key, PARAMETER_INT); return (p != nullptr) ? p->nInt : def; }
+	float GetFloat(StringId key, float def = 0.0f) const { const Parameter* p = Find(key, PARAMETER_FLOAT); return (p != nullptr) ? p->fFloat : def; }
+	Leadwerks::Vec3 GetVec3(StringId key, Leadwerks::Vec3 def = Leadwerks::Vec3()) const { const Parameter* p = Find(key, PARAMETER_VEC3); return (p != nullptr) ? Leadwerks::Vec3(p->vVec3[0], p->vVec3[1], p->vVec3[2]) : def; }
+	std::string GetString(StringId key, const std::string& def = std::string()) const { const Parameter* p = Find(key, PARAMETER_STRING); return (p != nullptr) ? strings[p->nString] : def; }
+	void* GetGameObject(StringId key, void* def = nullptr) const { const Parameter* p = Find(key, PARAMETER_DATA); return (p != nullptr) ? p->pData : def; }
+
+	bool Has(StringId key) const { return Index(key.Id()) != parameters.size(); }
+
+	void Remove(StringId key)
+	{
+		size_t index = Index(key.Id());
+		if (index == parameters.size()) { return; }
+
+		if (parameters[index].type == PARAMETER_STRING) { RemoveString(parameters[index].nString); }
+
+		parameters[index] = parameters.back();
+		parameters.pop_back();
+	}
+
+	void Clear(void) { parameters.clear(); strings.clear(); }
+
+	/* Positional access, for code that walks every property (such as the event recorder) */
+	size_t Count(void) const { return parameters.size(); }
+	StringId KeyAt(size_t index) const { return StringId::Find(parameters[index].nKey); }
+	ParameterType TypeAt(size_t index) const { return parameters[index].type; }
+	const Parameter& At(size_t index) const { return parameters[index]; }
+	const std::string& StringAt(size_t index) const { return strings[parameters[index].nString]; }
 
 protected:
-	
+
 private:
-	IntMap intMap;
-	FloatMap floatMap;
-	Vec3Map vec3Map;
-	StringMap stringMap;		
-	DataMap dataMap;
+
+	size_t Index(uint32_t nKey) const
+	{
+		size_t index = 0;
+		while (index < parameters.size() && parameters[index].nKey != nKey) { index += 1; }
+		return index;
+	}
+
+	const Parameter* Find(StringId key, ParameterType type) const
+	{
+		size_t index = Index(key.Id());
+		return (index != parameters.size() && parameters[index].type == type) ? &parameters[index] : nullptr;
+	}
+
+	// < Finds or adds the property with the given key, as the given type. A key
+	// * holds a single value; setting it as another type replaces it.
+	Parameter* Slot(StringId key, ParameterType type)
+	{
+		if (key == StringId()) { return nullptr; }
+
+		size_t index = Index(key.Id());
+		if (index != parameters.size())
+		{
+			Parameter& existing = parameters[index];
+			if (existing.type == type) { return &existing; }
+
+			if (existing.type == PARAMETER_STRING) { RemoveString(existing.nString); }
+			parameters.erase(parameters.begin() + index);
+		}
+		else if (!key.Register())
+		{
+			// < First use of the key in this map; it is registered so it can be
+			// * named later. A key that collides with another name is refused
+			// * rather than merged with it; Register has reported it.
+			return nullptr;
+		}
+
+		Parameter parameter;
+		parameter.nKey = key.Id();
+		parameter.type = type;
+		parameter.pData = nullptr;
+
+		if (type == PARAMETER_STRING)
+		{
+			parameter.nString = (uint32_t)(strings.size());
+			strings.push_back(std::string());
+		}
+
+		parameters.push_back(parameter);
+		return &parameters.back();
+	}
+
+	// < Removes a string value, moving the last one into its place.
+	void RemoveString(uint32_t nString)
+	{
+		uint32_t nLast = (uint32_t)(strings.size() - 1);
+		if (nString != nLast)
+		{
+			strings[nString].swap(strings[nLast]);
+			for (size_t i = 0; i < parameters.size(); i++)
+			{
+				if (parameters[i].type == PARAMETER_STRING && parameters[i].nString == nLast) { parameters[i].nString = nString; }
+			}
+		}
+
+		strings.pop_back();
+	}
+
+	std::vector<Parameter> parameters;
+	std::vector<std::string> strings;
 
 }; // end class.
 
-#endif // _PARAMETERMAP_HPP_
\ No newline at end of file
+#endif // _PARAMETERMAP_HPP_
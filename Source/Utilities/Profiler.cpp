@@ -0,0 +1,262 @@
+#pragma once
+#include "Profiler.hpp"
+#include "Macros.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+Profiler gProfiler;
+
+/* The rolling per-frame totals of one scope name */
+struct Profiler::ScopeWindow
+{
+	uint64_t        nFrames[SUMMARY_FRAMES];
+	uint64_t        nSum;               // The sum of nFrames.
+	uint64_t        nCurrent;           // The total of the frame being recorded.
+	uint32_t        nCalls;             // Calls in the frame being recorded.
+};
+
+/* Owned by each thread that records a scope; retires the thread's buffer
+   when the thread exits so EndFrame can free it once drained. */
+struct Profiler::ThreadHandle
+{
+	ThreadBuffer*   pBuffer;
+
+	ThreadHandle(void) : pBuffer(nullptr) { }
+	~ThreadHandle(void) { if (pBuffer != nullptr) { pBuffer->bRetired.store(true, std::memory_order_release); } }
+};
+
+Profiler::Profiler(void)
+	: m_bEnabled(false), m_nNextThreadId(0), m_nFrame(0), m_nFrameStartMicros(0), m_nFrameMicros(0)
+	, m_bCapturing(false), m_nMaxCaptures(0), m_nDropped(0), m_nDroppedCaptures(0) { }
+
+Profiler::~Profiler(void)
+{
+	for (size_t i = 0; i < m_buffers.size(); i++) { SAFE_DELETE(m_buffers[i]); }
+	m_buffers.clear();
+}
+
+uint32_t& Profiler::Depth(void)
+{
+	static thread_local uint32_t nDepth = 0;
+	return nDepth;
+}
+
+Profiler::ThreadBuffer* Profiler::AcquireBuffer(void)
+{
+	static thread_local ThreadHandle handle;
+	if (handle.pBuffer != nullptr) { return handle.pBuffer; }
+
+	ThreadBuffer* pBuffer = new ThreadBuffer();
+	pBuffer->bRetired.store(false, std::memory_order_relaxed);
+	pBuffer->nDropped.store(0, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	pBuffer->nThreadId = m_nNextThreadId++;
+	m_buffers.push_back(pBuffer);
+
+	handle.pBuffer = pBuffer;
+	return pBuffer;
+}
+
+void Profiler::Record(const Sample& sample)
+{
+	ThreadBuffer* pBuffer = AcquireBuffer();
+
+	if (!pBuffer->samples.TryPush(sample)) { pBuffer->nDropped.fetch_add(1, std::memory_order_relaxed); }
+}
+
+void Profiler::AddToSummary(const Sample& sample)
+{
+	size_t index = 0;
+
+	auto iter = m_nameIndex.find(sample.cName);
+	if (iter != m_nameIndex.end()) { index = iter->second; }
+	else
+	{
+		// < The same literal may live at several addresses, one per
+		// * translation unit, so unknown pointers are matched by name.
+		index = m_summary.size();
+		for (size_t i = 0; i < m_summary.size(); i++)
+		{
+			if (strcmp(m_summary[i].cName, sample.cName) == 0) { index = i; break; }
+		}
+
+		if (index == m_summary.size())
+		{
+			ScopeSummary summary = { sample.cName, sample.nDepth, 0, 0, 0 };
+			m_summary.push_back(summary);
+
+			ScopeWindow window;
+			memset(&window, 0, sizeof(window));
+			m_windows.push_back(window);
+		}
+
+		m_nameIndex[sample.cName] = index;
+	}
+
+	m_summary[index].nDepth = sample.nDepth;
+	m_windows[index].nCurrent += sample.nDurationMicros;
+	m_windows[index].nCalls += 1;
+}
+
+void Profiler::EndFrame(void)
+{
+	uint64_t nowMicros = Timer::Micros();
+
+	m_lastFrame.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto iter = m_buffers.begin();
+		while (iter != m_buffers.end())
+		{
+			ThreadBuffer* pBuffer = *iter;
+
+			// < Read the flag first; a retired thread pushes nothing more,
+			// * so once it is drained its buffer can go.
+			bool bRetired = pBuffer->bRetired.load(std::memory_order_acquire);
+
+			ThreadSample sample;
+			sample.nThreadId = pBuffer->nThreadId;
+
+			while (pBuffer->samples.TryPop(sample.sample))
+			{
+				AddToSummary(sample.sample);
+				m_lastFrame.push_back(sample);
+
+				if (!m_bCapturing) { continue; }
+
+				if (m_captures.size() < m_nMaxCaptures) { m_captures.push_back(sample); }
+				else { m_nDroppedCaptures += 1; }
+			}
+
+			m_nDropped += pBuffer->nDropped.exchange(0, std::memory_order_relaxed);
+
+			if (bRetired)
+			{
+				SAFE_DELETE(pBuffer);
+				iter = m_buffers.erase(iter);
+			}
+			else
+			{
+				iter++;
+			}
+		}
+	}
+
+	// < Roll this frame's totals into each scope's window.
+	unsigned nSlot = m_nFrame % SUMMARY_FRAMES;
+	unsigned nFrames = (m_nFrame + 1 < SUMMARY_FRAMES) ? (m_nFrame + 1) : SUMMARY_FRAMES;
+
+	for (size_t i = 0; i < m_windows.size(); i++)
+	{
+		ScopeWindow& window = m_windows[i];
+		ScopeSummary& summary = m_summary[i];
+
+		window.nSum -= window.nFrames[nSlot];
+		window.nFrames[nSlot] = window.nCurrent;
+		window.nSum += window.nCurrent;
+
+		summary.nCalls = window.nCalls;
+		summary.nMeanMicros = window.nSum / nFrames;
+		summary.nMaxMicros = 0;
+		for (unsigned n = 0; n < nFrames; n++)
+		{
+			if (window.nFrames[n] > summary.nMaxMicros) { summary.nMaxMicros = window.nFrames[n]; }
+		}
+
+		window.nCurrent = 0;
+		window.nCalls = 0;
+	}
+
+	m_nFrame += 1;
+
+	m_nFrameMicros = (m_nFrameStartMicros != 0) ? (nowMicros - m_nFrameStartMicros) : 0;
+	m_nFrameStartMicros = nowMicros;
+}
+
+void Profiler::StartCapture(size_t nMaxSamples)
+{
+	m_captures.clear();
+	m_captures.reserve(nMaxSamples);
+
+	m_nMaxCaptures = nMaxSamples;
+	m_nDroppedCaptures = 0;
+	m_bCapturing = true;
+}
+
+void Profiler::WriteTrace(std::ostream& out) const
+{
+	uint64_t nOriginMicros = m_captures.empty() ? 0 : m_captures.front().sample.nBeginMicros;
+	for (size_t i = 0; i < m_captures.size(); i++)
+	{
+		if (m_captures[i].sample.nBeginMicros < nOriginMicros) { nOriginMicros = m_captures[i].sample.nBeginMicros; }
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	for (size_t i = 0; i < m_captures.size(); i++)
+	{
+		if (i != 0) { out << ","; }
+		out << "\n";
+
+		WriteTraceEvent(out, m_captures[i], nOriginMicros);
+	}
+
+	out << "\n]}\n";
+}
+
+void Profiler::WriteTraceEvent(std::ostream& out, const ThreadSample& sample, uint64_t nOriginMicros)
+{
+	out << "{\"name\":\"";
+
+	// < Names are literals, but escape anything JSON would choke on.
+	for (const char* c = sample.sample.cName; *c != '\0'; c++)
+	{
+		if (*c == '"' || *c == '\\') { out << '\\'; }
+		out << *c;
+	}
+
+	out << "\",\"ph\":\"X\",\"pid\":1"
+		<< ",\"tid\":" << sample.nThreadId
+		<< ",\"ts\":" << (sample.sample.nBeginMicros - nOriginMicros)
+		<< ",\"dur\":" << sample.sample.nDurationMicros << "}";
+}
+
+bool Profiler::WriteTrace(const std::string& cPath) const
+{
+	std::ofstream out(cPath.c_str(), std::ios::out | std::ios::trunc);
+	if (!out.is_open()) { return false; }
+
+	WriteTrace(out);
+	return true;
+}
+
+void Profiler::DrawSummary(Leadwerks::Context* pContext, int nX, int nY) const
+{
+	const int LINE_HEIGHT = 16;
+
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(2);
+
+	line << "Frame " << (m_nFrameMicros / 1000.0) << " ms";
+	if (Dropped() != 0) { line << " (" << Dropped() << " samples dropped)"; }
+	pContext->DrawText(line.str(), nX, nY);
+
+	for (size_t i = 0; i < m_summary.size(); i++)
+	{
+		const ScopeSummary& summary = m_summary[i];
+
+		line.str("");
+		line << std::string(summary.nDepth * 2, ' ') << summary.cName
+			<< "  " << (summary.nMeanMicros / 1000.0) << " ms"
+			<< "  max " << (summary.nMaxMicros / 1000.0) << " ms"
+			<< "  x" << summary.nCalls;
+
+		pContext->DrawText(line.str(), nX, nY + (int)(i + 1) * LINE_HEIGHT);
+	}
+}
@@ -0,0 +1,222 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: Profiler.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for Profiler utility.
+                 The Profiler times named scopes on any
+                 thread. Each thread writes its samples
+                 into its own lock-free RingBuffer, which
+                 the main thread drains once a frame into
+                 a rolling per-scope summary and, while
+                 capturing, a Chrome trace-event log.
+                 Scope names must be string literals.
+
+    Functions: 1. PROFILE_SCOPE(cName);
+
+               2. void SetEnabled(bool bEnabled);
+
+               3. void EndFrame(void);
+
+               4. void StartCapture(size_t nMaxSamples);
+
+               5. bool WriteTrace(const std::string& cPath) const;
+
+               6. void DrawSummary(Leadwerks::Context* pContext, int nX, int nY) const;
+
+    Example:
+
+        void World::Update(float dt)
+        {
+            PROFILE_SCOPE("World::Update");
+
+            ...
+        }
+
+        // < Open the written file in chrome://tracing.
+        gProfiler.WriteTrace("trace.json");
+
+---------------------------------------------------------*/
+
+#ifndef _PROFILER_HPP_
+	#define _PROFILER_HPP_
+
+#pragma once
+#include "Leadwerks.h"
+#include "RingBuffer.hpp"
+#include "Timer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Profiler
+{
+public:
+
+	/* A single timed scope */
+	struct Sample
+	{
+		const char*         cName;
+		uint64_t            nBeginMicros;
+		uint32_t            nDurationMicros;
+		uint32_t            nDepth;             // The number of scopes open around this one.
+	};
+
+	/* A sample and the id of the thread that recorded it */
+	struct ThreadSample
+	{
+		uint32_t            nThreadId;
+		Sample              sample;
+	};
+
+	/* The rolling summary of one scope name */
+	struct ScopeSummary
+	{
+		const char*         cName;
+		uint32_t            nDepth;             // The depth it was last seen at.
+		uint32_t            nCalls;             // Calls within the last frame.
+		uint64_t            nMeanMicros;        // Mean time per frame over the window.
+		uint64_t            nMaxMicros;         // Longest frame total over the window.
+	};
+
+	/* Frames the summary is averaged over */
+	enum { SUMMARY_FRAMES = 60, THREAD_SAMPLES = 4096 };
+
+	Profiler(void);
+	~Profiler(void);
+
+	void SetEnabled(bool bEnabled) { m_bEnabled.store(bEnabled, std::memory_order_relaxed); }
+	bool IsEnabled(void) const { return m_bEnabled.load(std::memory_order_relaxed); }
+
+	/* Records a finished scope on the calling thread. Used by ProfileScope. */
+	void Record(const Sample& sample);
+
+	/* Main thread only. Drains every thread's samples into the summary and,
+	   while capturing, the trace. Call once at the end of every frame. */
+	void EndFrame(void);
+
+	/* Keeps the samples drained by EndFrame, up to the given count, for WriteTrace */
+	void StartCapture(size_t nMaxSamples);
+	void StopCapture(void) { m_bCapturing = false; }
+	bool IsCapturing(void) const { return m_bCapturing; }
+
+	/* Writes the captured samples as Chrome trace-event JSON */
+	void WriteTrace(std::ostream& out) const;
+	bool WriteTrace(const std::string& cPath) const;
+
+	/* Every sample drained by the last EndFrame */
+	const std::vector<ThreadSample>& LastFrame(void) const { return m_lastFrame; }
+
+	/* Writes a single complete ("X") trace event, timed from the given origin */
+	static void WriteTraceEvent(std::ostream& out, const ThreadSample& sample, uint64_t nOriginMicros);
+
+	/* Scopes in the order they were first seen */
+	const std::vector<ScopeSummary>& Summary(void) const { return m_summary; }
+	uint64_t FrameMicros(void) const { return m_nFrameMicros; }
+
+	/* Draws the summary as text; call from a Draw phase */
+	void DrawSummary(Leadwerks::Context* pContext, int nX, int nY) const;
+
+	/* Samples lost because a thread's ring or the capture was full */
+	uint64_t Dropped(void) const { return m_nDropped + m_nDroppedCaptures; }
+
+	/* The calling thread's scope depth, used by ProfileScope */
+	static uint32_t& Depth(void);
+
+private:
+
+	struct ThreadBuffer
+	{
+		uint32_t                                    nThreadId;      // The id written to the trace.
+		std::atomic<bool>                           bRetired;       // The thread has exited.
+		std::atomic<uint64_t>                       nDropped;
+		RingBuffer<Sample, THREAD_SAMPLES>          samples;
+	};
+
+	struct ThreadHandle;
+	struct ScopeWindow;
+
+	ThreadBuffer* AcquireBuffer(void);
+	void AddToSummary(const Sample& sample);
+
+	std::atomic<bool>                               m_bEnabled;
+
+	std::mutex                                      m_mutex;        // Guards m_buffers; taken once per thread and once per frame.
+	std::vector<ThreadBuffer*>                      m_buffers;
+	uint32_t                                        m_nNextThreadId;
+
+	std::vector<ScopeWindow>                        m_windows;      // One per scope name, matching m_summary.
+	std::vector<ScopeSummary>                       m_summary;
+	std::unordered_map<const char*, size_t>         m_nameIndex;    // Name pointer to its index in m_summary.
+	unsigned                                        m_nFrame;       // Frames summarised so far.
+	uint64_t                                        m_nFrameStartMicros;
+	uint64_t                                        m_nFrameMicros;
+
+	std::vector<ThreadSample>                       m_lastFrame;
+
+	bool                                            m_bCapturing;
+	size_t                                          m_nMaxCaptures;
+	std::vector<ThreadSample>                       m_captures;
+	uint64_t                                        m_nDropped;
+	uint64_t                                        m_nDroppedCaptures;
+
+}; // < end class.
+
+extern Profiler gProfiler;
+
+/* Times the enclosing scope. Does nothing but read a flag while the Profiler is disabled. */
+class ProfileScope
+{
+public:
+
+	explicit ProfileScope(const char* cName) : m_cName(cName), m_nBeginMicros(0)
+	{
+		if (!gProfiler.IsEnabled()) { return; }
+
+		m_nBeginMicros = Timer::Micros();
+		Profiler::Depth() += 1;
+	}
+
+	~ProfileScope(void)
+	{
+		if (m_nBeginMicros == 0) { return; }
+
+		uint32_t& nDepth = Profiler::Depth();
+		nDepth -= 1;
+
+		Profiler::Sample sample = { m_cName, m_nBeginMicros, (uint32_t)(Timer::Micros() - m_nBeginMicros), nDepth };
+		gProfiler.Record(sample);
+	}
+
+private:
+
+	ProfileScope(const ProfileScope&);
+	ProfileScope& operator=(const ProfileScope&);
+
+	const char*     m_cName;
+	uint64_t        m_nBeginMicros;     // 0 when the Profiler was disabled on entry.
+
+}; // < end class.
+
+// < Defining PROFILER_DISABLED compiles every scope out entirely.
+#define PROFILE_CONCAT_INNER(a, b)  a##b
+#define PROFILE_CONCAT(a, b)        PROFILE_CONCAT_INNER(a, b)
+
+#if defined(PROFILER_DISABLED)
+	#define PROFILE_SCOPE(cName)
+#else
+	#define PROFILE_SCOPE(cName)    ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(cName)
+#endif
+
+#endif // _PROFILER_HPP_
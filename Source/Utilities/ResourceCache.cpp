@@ -0,0 +1,50 @@
+#pragma once
+#include "ResourceCache.hpp"
+#include "Timer.hpp"
+
+void ResourceCache::Release(StringId key)
+{
+	auto iter = m_entries.find(key);
+	if (iter == m_entries.end()) { return; }
+
+	Entry& entry = iter->second;
+	assert(entry.nRefs > 0);
+	if (entry.nRefs == 0) { return; }
+
+	entry.nRefs -= 1;
+	if (entry.nRefs != 0) { return; }
+
+	entry.pfnPark(entry.pResource);
+	entry.nReleasedMicros = Timer::Micros();
+}
+
+void ResourceCache::Update(void)
+{
+	uint64_t nowMicros = Timer::Micros();
+
+	auto iter = m_entries.begin();
+	while (iter != m_entries.end())
+	{
+		Entry& entry = iter->second;
+
+		if (entry.nRefs == 0 && nowMicros - entry.nReleasedMicros >= m_nGraceMicros)
+		{
+			entry.pfnDestroy(entry.pResource);
+			iter = m_entries.erase(iter);
+		}
+		else
+		{
+			iter++;
+		}
+	}
+}
+
+void ResourceCache::Clear(void)
+{
+	for (auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+	{
+		iter->second.pfnDestroy(iter->second.pResource);
+	}
+
+	m_entries.clear();
+}
@@ -0,0 +1,187 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: ResourceCache.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for ResourceCache utility.
+                 The ResourceCache shares assets between
+                 states. Each asset is keyed by a StringId
+                 and reference counted; once nothing uses
+                 it, it is kept for a grace period, so a
+                 state that wants it again soon after
+                 gets it back without reloading.
+                 Leadwerks entities are hidden while
+                 unused. Main thread only.
+
+    Functions: 1. template <typename T, typename F>
+                  T* Acquire(StringId key, F create);
+
+               2. void Release(StringId key);
+
+               3. void Update(void);
+
+               4. void Clear(void);
+
+    Example:
+
+        m_pLight = pCache->Acquire<Leadwerks::DirectionalLight>("DefaultState/Light", []() {
+            return Leadwerks::DirectionalLight::Create();
+        });
+
+        ...
+
+        pCache->Release("DefaultState/Light");
+
+---------------------------------------------------------*/
+
+#ifndef _RESOURCE_CACHE_HPP_
+	#define _RESOURCE_CACHE_HPP_
+
+#pragma once
+#include "Leadwerks.h"
+#include "Macros.hpp"
+#include "StringId.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+
+/* How the cache destroys, parks and revives a resource. Leadwerks objects are
+   released rather than deleted, and entities are hidden while unused. */
+template <typename T, typename Enable = void>
+struct ResourceTraits
+{
+	static void Destroy(T* pResource) { delete pResource; }
+	static void Park(T* pResource) { }
+	static void Revive(T* pResource) { }
+};
+
+template <typename T>
+struct ResourceTraits<T, typename std::enable_if<std::is_base_of<Leadwerks::Object, T>::value>::type>
+{
+	static void Destroy(T* pResource) { pResource->Release(); }
+	static void Park(T* pResource) { Hide(pResource, std::is_base_of<Leadwerks::Entity, T>()); }
+	static void Revive(T* pResource) { Show(pResource, std::is_base_of<Leadwerks::Entity, T>()); }
+
+private:
+	static void Hide(T* pResource, std::true_type) { pResource->Hide(); }
+	static void Hide(T* pResource, std::false_type) { }
+	static void Show(T* pResource, std::true_type) { pResource->Show(); }
+	static void Show(T* pResource, std::false_type) { }
+};
+
+class ResourceCache
+{
+	CLASS_TYPE(ResourceCache);
+
+	struct Entry
+	{
+		void*                   pResource;
+		const std::type_info*   pType;              // Guards against one key being used for two types.
+		void                    (*pfnDestroy)(void*);
+		void                    (*pfnPark)(void*);
+		void                    (*pfnRevive)(void*);
+		uint32_t                nRefs;
+		uint64_t                nReleasedMicros;    // When the last reference was released.
+	};
+
+	typedef std::unordered_map<StringId, Entry> EntryMap;
+
+public:
+
+	/* Unused resources are kept this long before they are destroyed */
+	enum { DEFAULT_GRACE_MICROS = 5000000 };
+
+	ResourceCache(void) : m_nGraceMicros(DEFAULT_GRACE_MICROS), m_nHits(0), m_nMisses(0) { }
+	~ResourceCache(void) { Clear(); }
+
+	/* Returns the resource stored under the given key, adding a reference. If
+	   there is none, create() is called to make it; create must not use the cache.
+	   Returns nullptr if create does, or the key collides with another name. */
+	template <typename T, typename F>
+	T* Acquire(StringId key, F create);
+
+	/* Drops a reference. The resource is parked, and destroyed by Update once
+	   the grace period has passed without it being acquired again. */
+	void Release(StringId key);
+
+	/* Destroys parked resources whose grace period has passed */
+	void Update(void);
+
+	/* Destroys every resource, used or not */
+	void Clear(void);
+
+	void SetGracePeriod(uint64_t nMicros) { m_nGraceMicros = nMicros; }
+
+	bool Contains(StringId key) const { return m_entries.find(key) != m_entries.end(); }
+	uint32_t RefCount(StringId key) const { auto iter = m_entries.find(key); return (iter != m_entries.end()) ? iter->second.nRefs : 0; }
+
+	size_t Size(void) const { return m_entries.size(); }
+	uint64_t Hits(void) const { return m_nHits; }
+	uint64_t Misses(void) const { return m_nMisses; }
+
+private:
+
+	template <typename T> static void DestroyStub(void* p) { ResourceTraits<T>::Destroy(static_cast<T*>(p)); }
+	template <typename T> static void ParkStub(void* p) { ResourceTraits<T>::Park(static_cast<T*>(p)); }
+	template <typename T> static void ReviveStub(void* p) { ResourceTraits<T>::Revive(static_cast<T*>(p)); }
+
+	EntryMap                m_entries;
+	uint64_t                m_nGraceMicros;
+
+	uint64_t                m_nHits;            // Acquires served from the cache.
+	uint64_t                m_nMisses;          // Acquires that had to create the resource.
+
+}; // < end class.
+
+template <typename T, typename F>
+T* ResourceCache::Acquire(StringId key, F create)
+{
+	auto iter = m_entries.find(key);
+	if (iter != m_entries.end())
+	{
+		// < A different name with the same id is a collision, not a hit.
+		if (strcmp(iter->first.c_str(), key.c_str()) != 0 && !key.Register()) { return nullptr; }
+
+		Entry& entry = iter->second;
+		assert(*entry.pType == typeid(T));
+
+		if (entry.nRefs == 0) { entry.pfnRevive(entry.pResource); }
+		entry.nRefs += 1;
+		m_nHits += 1;
+
+		return static_cast<T*>(entry.pResource);
+	}
+
+	// < A key that collides with another name is refused rather than handed
+	// * that name's resource; Register has reported it.
+	if (!key.Register()) { return nullptr; }
+
+	T* pResource = create();
+	if (pResource == nullptr) { return nullptr; }
+
+	Entry entry;
+	entry.pResource = pResource;
+	entry.pType = &typeid(T);
+	entry.pfnDestroy = &ResourceCache::DestroyStub<T>;
+	entry.pfnPark = &ResourceCache::ParkStub<T>;
+	entry.pfnRevive = &ResourceCache::ReviveStub<T>;
+	entry.nRefs = 1;
+	entry.nReleasedMicros = 0;
+
+	m_entries.insert(std::make_pair(key, entry));
+	m_nMisses += 1;
+
+	return pResource;
+}
+
+#endif // _RESOURCE_CACHE_HPP_
@@ -0,0 +1,85 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: RingBuffer.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for RingBuffer utility.
+                 The RingBuffer class is a fixed-size,
+                 lock-free queue for exactly one producer
+                 thread and one consumer thread. Neither
+                 side ever blocks or allocates.
+
+    Functions: 1. bool TryPush(const T& value);
+
+               2. bool TryPop(T& value);
+
+               3. size_t Size(void) const;
+
+---------------------------------------------------------*/
+
+#ifndef _RING_BUFFER_HPP_
+	#define _RING_BUFFER_HPP_
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t N>
+class RingBuffer
+{
+	static_assert(N >= 2 && (N & (N - 1)) == 0, "RingBuffer capacity must be a power of two.");
+
+public:
+
+	RingBuffer(void) : m_nHead(0), m_nTail(0) { }
+
+	/* Producer only. Returns false, dropping the value, if the buffer is full. */
+	bool TryPush(const T& value)
+	{
+		size_t nTail = m_nTail.load(std::memory_order_relaxed);
+		if (nTail - m_nHead.load(std::memory_order_acquire) == N) { return false; }
+
+		m_items[nTail & (N - 1)] = value;
+		m_nTail.store(nTail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/* Consumer only. Returns false if the buffer is empty. */
+	bool TryPop(T& value)
+	{
+		size_t nHead = m_nHead.load(std::memory_order_relaxed);
+		if (nHead == m_nTail.load(std::memory_order_acquire)) { return false; }
+
+		value = m_items[nHead & (N - 1)];
+		m_nHead.store(nHead + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/* Approximate when called while the other side is running */
+	size_t Size(void) const { return m_nTail.load(std::memory_order_acquire) - m_nHead.load(std::memory_order_acquire); }
+	bool Empty(void) const { return Size() == 0; }
+
+	static size_t Capacity(void) { return N; }
+
+private:
+
+	// < Head and tail are padded onto their own cache lines so the producer
+	// * and consumer do not contend for them. Padding, rather than alignas,
+	// * keeps the buffer safe to embed in heap-allocated objects.
+	std::atomic<size_t>     m_nHead;                                        // The next slot to pop; written by the consumer.
+	char                    m_headPad[64 - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t>     m_nTail;                                        // The next slot to push; written by the producer.
+	char                    m_tailPad[64 - sizeof(std::atomic<size_t>)];
+	T                       m_items[N];
+
+}; // < end class.
+
+#endif // _RING_BUFFER_HPP_
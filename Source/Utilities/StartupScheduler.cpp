@@ -0,0 +1,266 @@
+#pragma once
+#include "StartupScheduler.hpp"
+#include "Profiler.hpp"
+#include "Timer.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+StartupReport gStartupReport;
+
+void StartupReport::Reset(void)
+{
+	m_nBeginMicros = 0;
+	m_nServicesMicros = 0;
+	m_nFirstFrameMicros = 0;
+	m_nFirstStateMicros = 0;
+	m_services.clear();
+}
+
+void StartupReport::Begin(void)
+{
+	Reset();
+	m_nBeginMicros = Timer::Micros();
+}
+
+uint64_t StartupReport::Elapsed(void) const
+{
+	return (m_nBeginMicros != 0) ? (Timer::Micros() - m_nBeginMicros) : 0;
+}
+
+void StartupReport::MarkServicesDone(void)
+{
+	m_nServicesMicros = Elapsed();
+}
+
+void StartupReport::MarkFirstFrame(void)
+{
+	if (m_nFirstFrameMicros == 0) { m_nFirstFrameMicros = Elapsed(); }
+}
+
+void StartupReport::MarkFirstStateFrame(void)
+{
+	if (m_nFirstStateMicros == 0) { m_nFirstStateMicros = Elapsed(); }
+}
+
+void StartupReport::Dump(std::ostream& out) const
+{
+	out << std::fixed << std::setprecision(2);
+
+	out << "Startup\n";
+	out << "  services: " << (m_nServicesMicros / 1000.0) << " ms\n";
+
+	for (auto& service : m_services)
+	{
+		out << "    " << std::left << std::setw(20) << service.cName << std::right
+			<< (service.bMainThread ? " main  " : " worker")
+			<< "  " << (service.nBeginMicros / 1000.0) << " - " << (service.nEndMicros / 1000.0) << " ms"
+			<< (service.bCreated ? "" : " (failed)") << "\n";
+	}
+
+	out << "  first frame: " << (m_nFirstFrameMicros / 1000.0) << " ms\n";
+	out << "  first frame with a state: " << (m_nFirstStateMicros / 1000.0) << " ms\n";
+}
+
+// < The shared state of a single Run. Everything but the services
+// * themselves is touched under the mutex.
+struct StartupScheduler::Schedule
+{
+	Container*                          pContainer;
+
+	std::mutex                          mutex;
+	std::condition_variable             changed;
+
+	std::vector<unsigned>               pending;        // Unmet dependencies, per type index.
+	std::vector<std::vector<size_t> >   dependents;     // Who waits on each type index.
+	std::deque<size_t>                  readyMain;
+	std::deque<size_t>                  readyAny;
+	size_t                              nRunning;
+	bool                                bFailed;
+	std::exception_ptr                  error;
+	std::vector<ServiceTiming>          timings;
+
+	// < Called with the lock held once a service has been created, or has failed.
+	void Finish(size_t index, bool bCreated)
+	{
+		nRunning -= 1;
+
+		if (!bCreated) { bFailed = true; }
+		else
+		{
+			for (size_t dependent : dependents[index])
+			{
+				pending[dependent] -= 1;
+				if (pending[dependent] != 0) { continue; }
+
+				bool bMain = (pContainer->m_components[dependent].nFlags & SERVICE_MAIN_THREAD) != 0;
+				(bMain ? readyMain : readyAny).push_back(dependent);
+			}
+		}
+
+		changed.notify_all();
+	}
+
+	void RunService(size_t index, bool bMainThread)
+	{
+		const char* cName = pContainer->m_components[index].cName;
+
+		ServiceTiming timing = { cName, gStartupReport.Elapsed(), 0, bMainThread, false };
+		std::exception_ptr thrown;
+
+		try
+		{
+			ProfileScope scope(cName);
+			timing.bCreated = (pContainer->Create(index) != nullptr);
+		}
+		catch (...)
+		{
+			thrown = std::current_exception();
+		}
+
+		timing.nEndMicros = gStartupReport.Elapsed();
+
+		if (!timing.bCreated && thrown == nullptr) { std::cout << "Service \"" << cName << "\" could not be created. \n"; }
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (thrown != nullptr && error == nullptr) { error = thrown; }
+		timings.push_back(timing);
+		Finish(index, timing.bCreated);
+	}
+};
+
+bool StartupScheduler::Run(void)
+{
+	Container::ComponentList& components = m_pContainer->m_components;
+	size_t nCount = components.size();
+
+	// < Every eager service is wanted, along with any lazy service an
+	// * eager one depends on.
+	std::vector<char> wanted(nCount, 0);
+	std::vector<size_t> open;
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		Container::Component& comp = components[i];
+		if (!comp.IsDeclared() || comp.IsCreated() || (comp.nFlags & SERVICE_LAZY) != 0) { continue; }
+
+		wanted[i] = 1;
+		open.push_back(i);
+	}
+
+	while (!open.empty())
+	{
+		size_t index = open.back();
+		open.pop_back();
+
+		for (size_t dependency : components[index].dependencies)
+		{
+			Container::Component& dep = components[dependency];
+			if (wanted[dependency] || !dep.IsDeclared() || dep.IsCreated()) { continue; }
+
+			wanted[dependency] = 1;
+			open.push_back(dependency);
+		}
+	}
+
+	Schedule schedule;
+	schedule.pContainer = m_pContainer;
+	schedule.pending.assign(nCount, 0);
+	schedule.dependents.resize(nCount);
+	schedule.nRunning = 0;
+	schedule.bFailed = false;
+
+	size_t nWanted = 0;
+	for (size_t i = 0; i < nCount; i++)
+	{
+		if (!wanted[i]) { continue; }
+		nWanted += 1;
+
+		for (size_t dependency : components[i].dependencies)
+		{
+			if (wanted[dependency])
+			{
+				schedule.pending[i] += 1;
+				schedule.dependents[dependency].push_back(i);
+			}
+			else if (!components[dependency].IsCreated())
+			{
+				// < Neither registered nor declared; the service would fail
+				// * to resolve it, so do not start anything.
+				std::cout << "Service \"" << components[i].cName << "\" depends on a service that was never registered. \n";
+				schedule.bFailed = true;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		if (!wanted[i] || schedule.pending[i] != 0) { continue; }
+
+		bool bMain = (components[i].nFlags & SERVICE_MAIN_THREAD) != 0;
+		(bMain ? schedule.readyMain : schedule.readyAny).push_back(i);
+	}
+
+	// < The main thread hands worker services to std::async as soon as they
+	// * are ready, and creates main-thread services itself in between.
+	std::vector<std::future<void> > workers;
+	{
+		std::unique_lock<std::mutex> lock(schedule.mutex);
+
+		while (true)
+		{
+			while (!schedule.bFailed && !schedule.readyAny.empty())
+			{
+				size_t index = schedule.readyAny.front();
+				schedule.readyAny.pop_front();
+				schedule.nRunning += 1;
+
+				Schedule* pSchedule = &schedule;
+				workers.push_back(std::async(std::launch::async, [pSchedule, index]() { pSchedule->RunService(index, false); }));
+			}
+
+			if (!schedule.bFailed && !schedule.readyMain.empty())
+			{
+				size_t index = schedule.readyMain.front();
+				schedule.readyMain.pop_front();
+				schedule.nRunning += 1;
+
+				lock.unlock();
+				schedule.RunService(index, true);
+				lock.lock();
+
+				continue;
+			}
+
+			// < Nothing ready and nothing running: either everything has
+			// * been created, something failed, or what is left is a cycle.
+			if (schedule.nRunning == 0) { break; }
+
+			schedule.changed.wait(lock);
+		}
+	}
+
+	for (auto& worker : workers) { worker.wait(); }
+
+	for (auto& timing : schedule.timings) { gStartupReport.AddService(timing); }
+	gStartupReport.MarkServicesDone();
+
+	if (schedule.error != nullptr) { std::rethrow_exception(schedule.error); }
+	if (schedule.bFailed) { return false; }
+
+	if (schedule.timings.size() != nWanted)
+	{
+		for (size_t i = 0; i < nCount; i++)
+		{
+			if (wanted[i] && !components[i].IsCreated()) { std::cout << "Service \"" << components[i].cName << "\" is part of a dependency cycle. \n"; }
+		}
+
+		return false;
+	}
+
+	return true;
+}
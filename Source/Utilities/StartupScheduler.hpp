@@ -0,0 +1,120 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: StartupScheduler.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for StartupScheduler utility.
+                 The StartupScheduler creates every
+                 service declared with a Container, each
+                 as soon as the services it depends on
+                 exist. Services that may run anywhere
+                 are created on worker threads while the
+                 main thread creates those bound to it.
+                 Lazy services are skipped unless an
+                 eager one depends on them.
+
+                 The StartupReport records how long each
+                 service took and the time to the first
+                 presented frame.
+
+    Functions: 1. bool Run(void);
+
+               2. void StartupReport::Begin(void);
+
+               3. void StartupReport::MarkFirstFrame(void);
+
+               4. void StartupReport::Dump(std::ostream& out) const;
+
+---------------------------------------------------------*/
+
+#ifndef _STARTUP_SCHEDULER_HPP_
+	#define _STARTUP_SCHEDULER_HPP_
+
+#pragma once
+#include "Container.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* How long a single service took to create */
+struct ServiceTiming
+{
+	const char*         cName;
+	uint64_t            nBeginMicros;       // Relative to StartupReport::Begin.
+	uint64_t            nEndMicros;
+	bool                bMainThread;        // Created on the main thread.
+	bool                bCreated;           // False if it failed, or a dependency did.
+};
+
+class StartupReport
+{
+public:
+
+	StartupReport(void) { Reset(); }
+
+	void Reset(void);
+
+	/* Marks the start of startup; everything else is timed from here */
+	void Begin(void);
+
+	void AddService(const ServiceTiming& timing) { m_services.push_back(timing); }
+	void MarkServicesDone(void);
+
+	/* The first frame was handed to the context, and the first frame that
+	   showed an active state. Only the first call of each counts. */
+	void MarkFirstFrame(void);
+	void MarkFirstStateFrame(void);
+
+	uint64_t Elapsed(void) const;
+	uint64_t ServicesMicros(void) const { return m_nServicesMicros; }
+	uint64_t FirstFrameMicros(void) const { return m_nFirstFrameMicros; }
+	uint64_t FirstStateFrameMicros(void) const { return m_nFirstStateMicros; }
+
+	/* Both first frames have been seen */
+	bool IsComplete(void) const { return m_nFirstFrameMicros != 0 && m_nFirstStateMicros != 0; }
+
+	const std::vector<ServiceTiming>& Services(void) const { return m_services; }
+
+	void Dump(std::ostream& out) const;
+
+private:
+
+	uint64_t                    m_nBeginMicros;
+	uint64_t                    m_nServicesMicros;      // Time to create every eager service.
+	uint64_t                    m_nFirstFrameMicros;    // Time to the first presented frame, or 0.
+	uint64_t                    m_nFirstStateMicros;    // Time to the first frame with an active state, or 0.
+	std::vector<ServiceTiming>  m_services;
+
+}; // < end class.
+
+extern StartupReport gStartupReport;
+
+class StartupScheduler
+{
+public:
+
+	explicit StartupScheduler(Container* pContainer) : m_pContainer(pContainer) { }
+
+	/* Main thread only. Creates every eager service, and any lazy service an
+	   eager one depends on. Returns false if a service failed to be created or
+	   the dependencies form a cycle; an exception thrown by a service is
+	   rethrown once every running service has finished. */
+	bool Run(void);
+
+private:
+
+	struct Schedule;
+
+	Container*                  m_pContainer;
+
+}; // < end class.
+
+#endif // _STARTUP_SCHEDULER_HPP_
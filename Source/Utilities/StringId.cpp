@@ -0,0 +1,45 @@
+#pragma once
+#include "StringId.hpp"
+#include "StringTable.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+// < Collisions merge two strings into one id, so they are reported in
+// * release builds too, not only asserted on.
+static void ReportCollision(uint32_t nId, const char* pExisting, const char* pString)
+{
+	std::cerr << "StringId collision: \"" << pExisting << "\" and \"" << pString << "\" both hash to " << nId << ". \n";
+}
+
+StringId StringId::Intern(const std::string& str)
+{
+	uint32_t nId = HashString(str.data(), str.size());
+
+	const char* pString = StringTable::Insert(nId, str.data(), str.size());
+	if (str.compare(pString) != 0) {
+		ReportCollision(nId, pString, str.c_str());
+		assert(false);	// Two strings hash to the same id.
+	}
+
+	return StringId(nId, pString);
+}
+
+StringId StringId::Find(uint32_t nId)
+{
+	return StringId(nId, StringTable::Lookup(nId));
+}
+
+bool StringId::Register(void) const
+{
+	if (m_pString == nullptr) { return true; }
+
+	const char* pString = StringTable::InsertStatic(m_nId, m_pString);
+	if (pString == m_pString || strcmp(pString, m_pString) == 0) { return true; }
+
+	ReportCollision(m_nId, pString, m_pString);
+	assert(false);	// Two strings hash to the same id.
+
+	return false;
+}
@@ -0,0 +1,119 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: StringId.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for StringId utility.
+                 The StringId class identifies a string
+                 by its 32-bit FNV-1a hash. Ids built from
+                 string literals are hashed at compile time
+                 and keep a pointer to the literal; runtime
+                 strings are interned once in the global
+                 StringTable, so comparing two ids never
+                 touches their characters.
+
+    Functions: 1. constexpr StringId(const char (&str)[N]);
+
+               2. static StringId Intern(const std::string& str);
+
+               3. static StringId Find(uint32_t nId);
+
+               4. bool Register(void) const;
+
+               5. StringId FromChars(const char* str);
+
+               6. const char* c_str(void) const;
+
+    Example:
+
+        StringId key = "deltaX";
+        StringId same = StringId::Intern(std::string("delta") + "X");
+
+        assert(key == same);
+
+---------------------------------------------------------*/
+
+#ifndef _STRING_ID_HPP_
+	#define _STRING_ID_HPP_
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+
+/* FNV-1a over the first nLength characters of the given string. */
+inline constexpr uint32_t HashString(const char* str, size_t nLength, uint32_t nHash = 2166136261u)
+{
+	return (nLength == 0) ? nHash : HashString(str + 1, nLength - 1, (nHash ^ (uint8_t)(str[0])) * 16777619u);
+}
+
+class StringId
+{
+public:
+
+	constexpr StringId(void) : m_nId(HashString("", 0)), m_pString("") { }
+
+	/* Builds an id from a string literal; the literal must outlive the id */
+	template <size_t N>
+	constexpr StringId(const char (&str)[N]) : m_nId(HashString(str, N - 1)), m_pString(str) { }
+
+	/* Builds an id from a runtime string, copying it the first time it is seen */
+	static StringId Intern(const std::string& str);
+
+	/* Builds an id from a string with static storage, such as a ClassType() name */
+	static StringId FromChars(const char* str) { return StringId(HashString(str, strlen(str)), str); }
+
+	/* Reverse lookup; the string is only known if the id was registered */
+	static StringId Find(uint32_t nId);
+
+	/* Makes this id known to reverse lookup. A hash collision with another
+	   string is reported, in every build, and returns false; containers keyed
+	   by the id refuse such a key rather than merge the two. */
+	bool Register(void) const;
+
+	constexpr uint32_t Id(void) const { return m_nId; }
+	const char* c_str(void) const { return (m_pString != nullptr) ? m_pString : "<unknown>"; }
+
+	constexpr bool operator== (const StringId& other) const { return m_nId == other.m_nId; }
+	constexpr bool operator!= (const StringId& other) const { return m_nId != other.m_nId; }
+	constexpr bool operator< (const StringId& other) const { return m_nId < other.m_nId; }
+
+private:
+
+	constexpr StringId(uint32_t nId, const char* pString) : m_nId(nId), m_pString(pString) { }
+
+	uint32_t    m_nId;          // The hash of the string.
+	const char* m_pString;      // The literal, or the interned copy, if known.
+
+}; // < end class.
+
+/* Registers a CLASS_TYPE name during static initialisation, so a ClassId
+   that collides with another id is reported before main rather than never.
+   Tag is a class local to ClassId() whose Name() gives the string. */
+template <typename Tag>
+struct StringIdRegistrar
+{
+	static const bool s_bRegistered;
+};
+
+template <typename Tag>
+const bool StringIdRegistrar<Tag>::s_bRegistered = StringId::FromChars(Tag::Name()).Register();
+
+namespace std
+{
+	template <>
+	struct hash<StringId>
+	{
+		size_t operator() (const StringId& id) const { return (size_t)(id.Id()); }
+	};
+}
+
+#endif // _STRING_ID_HPP_
@@ -0,0 +1,115 @@
+#pragma once
+#include "StringTable.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+StringTable::Slot           StringTable::s_slots[StringTable::CAPACITY];
+std::atomic<size_t>         StringTable::s_nSize(0);
+std::atomic<bool>           StringTable::s_bOverflowed(false);
+
+// < Serialises insertion, and guards the overflow map once the slots are
+// * three-quarters full.
+static std::mutex& InsertMutex(void)
+{
+	static std::mutex s_mutex;
+	return s_mutex;
+}
+
+static std::unordered_map<uint32_t, std::string>& Overflow(void)
+{
+	static std::unordered_map<uint32_t, std::string> s_overflow;
+	return s_overflow;
+}
+
+const char* StringTable::Lookup(uint32_t nId)
+{
+	// < Slots are only ever filled, each published before the next insertion
+	// * starts, so the first empty slot ends the probe.
+	for (size_t i = 0; i < CAPACITY; i++)
+	{
+		const Slot& slot = s_slots[(nId + i) & (CAPACITY - 1)];
+
+		const char* pString = slot.pString.load(std::memory_order_acquire);
+		if (pString == nullptr) { break; }
+		if (slot.nId == nId) { return pString; }
+	}
+
+	if (!s_bOverflowed.load(std::memory_order_acquire)) { return nullptr; }
+
+	std::lock_guard<std::mutex> lock(InsertMutex());
+	auto find = Overflow().find(nId);
+	return (find != Overflow().end()) ? find->second.c_str() : nullptr;
+}
+
+const char* StringTable::Insert(uint32_t nId, const char* str, size_t nLength)
+{
+	const char* pString = Lookup(nId);
+	if (pString != nullptr) { return pString; }
+
+	return Store(nId, str, nLength, true);
+}
+
+const char* StringTable::InsertStatic(uint32_t nId, const char* str)
+{
+	const char* pString = Lookup(nId);
+	if (pString != nullptr) { return pString; }
+
+	return Store(nId, str, strlen(str), false);
+}
+
+size_t StringTable::Size(void)
+{
+	return s_nSize.load(std::memory_order_relaxed);
+}
+
+const char* StringTable::Store(uint32_t nId, const char* str, size_t nLength, bool bCopy)
+{
+	std::lock_guard<std::mutex> lock(InsertMutex());
+
+	// < Another thread may have inserted the id while we waited.
+	for (size_t i = 0; i < CAPACITY; i++)
+	{
+		Slot& slot = s_slots[(nId + i) & (CAPACITY - 1)];
+
+		const char* pString = slot.pString.load(std::memory_order_relaxed);
+		if (pString != nullptr)
+		{
+			if (slot.nId == nId) { return pString; }
+			continue;
+		}
+
+		if (s_nSize.load(std::memory_order_relaxed) >= (CAPACITY / 4) * 3) { break; }
+
+		if (bCopy)
+		{
+			char* pCopy = new char[nLength + 1];
+			memcpy(pCopy, str, nLength);
+			pCopy[nLength] = '\0';
+			pString = pCopy;
+		}
+		else
+		{
+			pString = str;
+		}
+
+		slot.nId = nId;
+		slot.pString.store(pString, std::memory_order_release);
+		s_nSize.fetch_add(1, std::memory_order_relaxed);
+
+		return pString;
+	}
+
+	// < The slots are full; keep going, slower, in the overflow map.
+	auto find = Overflow().find(nId);
+	if (find == Overflow().end())
+	{
+		find = Overflow().insert(std::make_pair(nId, std::string(str, nLength))).first;
+		s_nSize.fetch_add(1, std::memory_order_relaxed);
+		s_bOverflowed.store(true, std::memory_order_release);
+	}
+
+	return find->second.c_str();
+}
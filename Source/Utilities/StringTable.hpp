@@ -0,0 +1,77 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: StringTable.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for StringTable utility.
+                 The StringTable is the global, thread-safe
+                 intern table behind StringId. Each string
+                 is stored once, literals in place, and
+                 lives until shutdown.
+                 Lookups are lock-free; only the first
+                 insertion of a string takes a lock.
+
+    Functions: 1. static const char* Insert(uint32_t nId, const char* str, size_t nLength);
+
+               2. static const char* InsertStatic(uint32_t nId, const char* str);
+
+               3. static const char* Lookup(uint32_t nId);
+
+               4. static size_t Size(void);
+
+---------------------------------------------------------*/
+
+#ifndef _STRING_TABLE_HPP_
+	#define _STRING_TABLE_HPP_
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class StringTable
+{
+	/* Open-addressed slots; must be a power of two */
+	enum { CAPACITY = 1 << 14 };
+
+	struct Slot
+	{
+		std::atomic<const char*>    pString;    // Published last, once the slot is fully written.
+		uint32_t                    nId;
+	};
+
+public:
+
+	/* Interns the given string under the given id, returning the stored copy.
+	   Returns the existing copy if the id is already present. */
+	static const char* Insert(uint32_t nId, const char* str, size_t nLength);
+
+	/* As Insert, but stores the given pointer rather than a copy. The string
+	   must have static storage, such as a literal. */
+	static const char* InsertStatic(uint32_t nId, const char* str);
+
+	/* Returns the string stored under the given id, or nullptr. Never locks
+	   unless the table has overflowed. */
+	static const char* Lookup(uint32_t nId);
+
+	/* The number of interned strings */
+	static size_t Size(void);
+
+private:
+	StringTable(void);
+
+	static const char* Store(uint32_t nId, const char* str, size_t nLength, bool bCopy);
+
+	static Slot                 s_slots[CAPACITY];
+	static std::atomic<size_t>  s_nSize;
+	static std::atomic<bool>    s_bOverflowed;
+
+}; // < end class.
+
+#endif // _STRING_TABLE_HPP_
@@ -0,0 +1,40 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: Timer.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for Timer utility.
+                 The Timer namespace provides access to
+                 a monotonic, high-resolution timestamp
+                 for measuring sub-millisecond work.
+
+    Functions: 1. uint64_t Micros(void);
+
+---------------------------------------------------------*/
+
+#ifndef _TIMER_HPP_
+	#define _TIMER_HPP_
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace Timer
+{
+	// < Returns a monotonic timestamp in microseconds. Only the difference
+	// * between two timestamps is meaningful.
+	inline uint64_t Micros(void)
+	{
+		return (uint64_t)(std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+} // < end namespace.
+
+#endif // _TIMER_HPP_
@@ -0,0 +1,342 @@
+/*-------------------------------------------------------
+                    <copyright>
+
+    File: TimerWheel.hpp
+    Language: C++
+
+    (C) Copyright Eden Softworks
+
+    Author: Joshua Allen
+    E-Mail: Joshua(AT)EdenSoftworks(DOT)net
+
+    Description: Header file for TimerWheel utility.
+                 The TimerWheel class provides a
+                 hierarchical timing wheel; timers are
+                 scheduled and cancelled in constant time
+                 and expire as the wheel is advanced.
+                 Advancing skips straight to the next
+                 occupied slot, so a long stall costs no
+                 more than the timers it expires.
+
+    Functions: 1. TimerHandle Schedule(const T& value, uint64_t nDelay, uint32_t nInterval = 0);
+
+               2. bool Cancel(TimerHandle handle);
+
+               3. template <typename F>
+                  void Advance(uint64_t nNow, F onExpire);
+
+               4. size_t Size(void);
+
+---------------------------------------------------------*/
+
+#ifndef _TIMER_WHEEL_HPP_
+	#define _TIMER_WHEEL_HPP_
+
+#pragma once
+#include "BitSet256.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+typedef uint64_t TimerHandle;
+
+#define INVALID_TIMER_HANDLE	0
+
+template <typename T>
+class TimerWheel
+{
+	// < Four levels of 256 slots, one tick per slot on the first level. The
+	// * wheel covers 2^32 ticks; longer delays are parked in the last level
+	// * and re-filed as the wheel turns.
+	enum eConstants { LEVELS = 4, SLOT_BITS = 8, SLOTS = 1 << SLOT_BITS, SLOT_MASK = SLOTS - 1, NIL = -1 };
+
+	struct Node
+	{
+		T               value;
+		uint64_t        nExpiry;
+		uint32_t        nInterval;
+		uint32_t        nGeneration;
+		int32_t         nPrev;
+		int32_t         nNext;
+		int32_t*        pHead;          // < The slot this node is linked into, or nullptr when free.
+	};
+
+public:
+
+	TimerWheel(uint64_t nNow = 0);
+
+	TimerHandle         Schedule(const T& value, uint64_t nDelay, uint32_t nInterval = 0);
+	bool                Cancel(TimerHandle handle);
+
+	template <typename F>
+	void                Advance(uint64_t nNow, F onExpire);
+
+	size_t              Size(void) const { return m_nActive; }
+	uint64_t            Now(void) const { return m_nCurrent; }
+
+private:
+
+	void                Link(int32_t index);
+	void                Unlink(int32_t index);
+	void                Release(int32_t index);
+	void                Cascade(int level, unsigned slot);
+	int                 NextOccupied(int level, unsigned slot) const;
+	uint64_t            NextTick(void) const;
+
+	std::vector<Node>   m_nodes;
+	int32_t             m_nFree;
+	size_t              m_nActive;
+
+	uint64_t            m_nCurrent;
+	int32_t             m_slots[LEVELS][SLOTS];
+	BitSet256           m_occupied[LEVELS];     // < One bit per non-empty slot.
+
+}; // < end class.
+
+template <typename T>
+TimerWheel<T>::TimerWheel(uint64_t nNow)
+	: m_nFree(NIL), m_nActive(0), m_nCurrent(nNow)
+{
+	for (int level = 0; level < LEVELS; level++)
+		for (int slot = 0; slot < SLOTS; slot++)
+			m_slots[level][slot] = NIL;
+}
+
+// < Schedules the given value to expire nDelay ticks from now. When nInterval
+// * is non-zero the timer is re-armed every nInterval ticks until cancelled.
+// * The current tick has already been processed, so the shortest delay is one
+// * tick.
+template <typename T>
+TimerHandle TimerWheel<T>::Schedule(const T& value, uint64_t nDelay, uint32_t nInterval)
+{
+	if (nDelay == 0) { nDelay = 1; }
+
+	int32_t index = m_nFree;
+	if (index != NIL)
+	{
+		m_nFree = m_nodes[index].nNext;
+	}
+	else
+	{
+		index = (int32_t)(m_nodes.size());
+		m_nodes.push_back(Node());
+		m_nodes[index].nGeneration = 1;
+	}
+
+	Node& node = m_nodes[index];
+	node.value = value;
+	node.nExpiry = m_nCurrent + nDelay;
+	node.nInterval = nInterval;
+	node.pHead = nullptr;
+
+	Link(index);
+	m_nActive += 1;
+
+	return ((TimerHandle)(node.nGeneration) << 32) | (TimerHandle)(index + 1);
+}
+
+// < Cancels the given timer. Returns false if the timer has already expired
+// * or was cancelled before.
+template <typename T>
+bool TimerWheel<T>::Cancel(TimerHandle handle)
+{
+	int32_t index = (int32_t)(handle & 0xffffffff) - 1;
+	uint32_t generation = (uint32_t)(handle >> 32);
+
+	if (index < 0 || index >= (int32_t)(m_nodes.size())) { return false; }
+
+	Node& node = m_nodes[index];
+	if (node.nGeneration != generation || node.pHead == nullptr) { return false; }
+
+	Unlink(index);
+	Release(index);
+
+	return true;
+}
+
+// < Turns the wheel up to the given time, calling onExpire(value, handle)
+// * for every timer that expires on the way. Callbacks may schedule and
+// * cancel timers.
+template <typename T>
+template <typename F>
+void TimerWheel<T>::Advance(uint64_t nNow, F onExpire)
+{
+	while (m_nCurrent < nNow)
+	{
+		// < Ticks with nothing to expire or re-file are skipped; with nothing
+		// * before the requested time, jump straight to it.
+		uint64_t nNext = (m_nActive != 0) ? NextTick() : nNow + 1;
+		if (nNext > nNow) { m_nCurrent = nNow; return; }
+
+		m_nCurrent = nNext;
+
+		// < Whenever a level wraps, the next slot of the level above it is
+		// * re-filed into the finer levels.
+		for (int level = 1; level < LEVELS; level++)
+		{
+			unsigned shift = level * SLOT_BITS;
+			if ((m_nCurrent & ((1ull << shift) - 1)) != 0) { break; }
+
+			Cascade(level, (unsigned)((m_nCurrent >> shift) & SLOT_MASK));
+		}
+
+		int32_t* pHead = &m_slots[0][m_nCurrent & SLOT_MASK];
+		while (*pHead != NIL)
+		{
+			int32_t index = *pHead;
+			Unlink(index);
+
+			Node& node = m_nodes[index];
+			TimerHandle handle = ((TimerHandle)(node.nGeneration) << 32) | (TimerHandle)(index + 1);
+			T value = node.value;
+
+			// < Repeats are re-armed from the tick they were due, so they never
+			// * drift however late the wheel is advanced.
+			if (node.nInterval != 0)
+			{
+				node.nExpiry = m_nCurrent + node.nInterval;
+				Link(index);
+			}
+			else
+			{
+				Release(index);
+			}
+
+			onExpire(value, handle);
+		}
+	}
+}
+
+template <typename T>
+void TimerWheel<T>::Link(int32_t index)
+{
+	Node& node = m_nodes[index];
+
+	uint64_t delta = (node.nExpiry > m_nCurrent) ? (node.nExpiry - m_nCurrent) : 0;
+	uint64_t expiry = m_nCurrent + delta;
+
+	// < Pick the finest level whose span still covers the delay.
+	int level = 0;
+	while (level < LEVELS - 1 && delta >= (1ull << ((level + 1) * SLOT_BITS))) { level += 1; }
+
+	// < Delays beyond the last level are parked in its furthest slot.
+	if (delta >= (1ull << (LEVELS * SLOT_BITS))) { expiry = m_nCurrent + (1ull << (LEVELS * SLOT_BITS)) - 1; }
+
+	unsigned slot = (unsigned)((expiry >> (level * SLOT_BITS)) & SLOT_MASK);
+	int32_t* pHead = &m_slots[level][slot];
+	m_occupied[level].Set(slot);
+
+	node.pHead = pHead;
+	node.nPrev = NIL;
+	node.nNext = *pHead;
+	if (*pHead != NIL) { m_nodes[*pHead].nPrev = index; }
+	*pHead = index;
+}
+
+template <typename T>
+void TimerWheel<T>::Unlink(int32_t index)
+{
+	Node& node = m_nodes[index];
+	assert(node.pHead != nullptr);
+
+	if (node.nPrev != NIL) { m_nodes[node.nPrev].nNext = node.nNext; }
+	else { *node.pHead = node.nNext; }
+
+	if (node.nNext != NIL) { m_nodes[node.nNext].nPrev = node.nPrev; }
+
+	if (*node.pHead == NIL)
+	{
+		ptrdiff_t offset = node.pHead - &m_slots[0][0];
+		m_occupied[offset >> SLOT_BITS].Reset((unsigned)(offset & SLOT_MASK));
+	}
+
+	node.pHead = nullptr;
+	node.nPrev = node.nNext = NIL;
+}
+
+template <typename T>
+void TimerWheel<T>::Release(int32_t index)
+{
+	Node& node = m_nodes[index];
+
+	node.value = T();
+	node.nGeneration += 1;
+	node.nNext = m_nFree;
+	m_nFree = index;
+
+	m_nActive -= 1;
+}
+
+template <typename T>
+void TimerWheel<T>::Cascade(int level, unsigned slot)
+{
+	int32_t index = m_slots[level][slot];
+	m_slots[level][slot] = NIL;
+	m_occupied[level].Reset(slot);
+
+	while (index != NIL)
+	{
+		int32_t next = m_nodes[index].nNext;
+
+		m_nodes[index].pHead = nullptr;
+		Link(index);
+
+		index = next;
+	}
+}
+
+// < How many slots on from the given one the first occupied slot of the
+// * level is, wrapping around; -1 if the level is empty.
+template <typename T>
+int TimerWheel<T>::NextOccupied(int level, unsigned slot) const
+{
+	const BitSet256& occupied = m_occupied[level];
+
+	// < The first word is visited twice: from the slot up, then, having
+	// * wrapped, below it.
+	for (unsigned n = 0; n <= 4; n++)
+	{
+		unsigned word = ((slot >> 6) + n) & 3;
+		uint64_t bits = occupied.Word(word);
+
+		if (n == 0) { bits &= ~0ull << (slot & 63); }
+		else if (n == 4) { bits &= ~(~0ull << (slot & 63)); }
+
+		if (bits != 0)
+		{
+			unsigned found = (word << 6) + BitSet256::CountTrailingZeros(bits);
+			return (int)((found - slot) & SLOT_MASK);
+		}
+	}
+
+	return -1;
+}
+
+// < The first tick after now on which a timer expires, or a slot above the
+// * first level is re-filed.
+template <typename T>
+uint64_t TimerWheel<T>::NextTick(void) const
+{
+	uint64_t nNext = UINT64_MAX;
+
+	int distance = NextOccupied(0, (unsigned)((m_nCurrent + 1) & SLOT_MASK));
+	if (distance >= 0) { nNext = m_nCurrent + 1 + distance; }
+
+	for (int level = 1; level < LEVELS; level++)
+	{
+		unsigned shift = level * SLOT_BITS;
+		uint64_t boundary = ((m_nCurrent >> shift) + 1) << shift;
+
+		distance = NextOccupied(level, (unsigned)((boundary >> shift) & SLOT_MASK));
+		if (distance < 0) { continue; }
+
+		uint64_t tick = boundary + ((uint64_t)(distance) << shift);
+		if (tick < nNext) { nNext = tick; }
+	}
+
+	return nNext;
+}
+
+#endif // _TIMER_WHEEL_HPP_
@@ -154,7 +154,13 @@ int main(int argc, const char *argv[])
     {
 		float deltaTime = 1.0f;
 		
-		do {
+		if (gAppCtrl->isPipelined()) {
+			// < The simulation runs on its own thread; this one only renders.
+			do {
+				Leadwerks::Time::Update(60);
+			} while (gAppCtrl->RenderPipelined());
+		}
+		else do {
 			Leadwerks::Time::Update(60);
 			deltaTime = Leadwerks::Time::GetSpeed();
 